@@ -1,12 +1,32 @@
 #include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <functional>
+#include <mutex>
 #include <numeric>
+#include <optional>
 #include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 #include <iostream>
+#include <memory>
+#include <memory_resource>
 
 #include <benchmark/benchmark.h>
 
+#include <dze/copyable_function.hpp>
 #include <dze/function.hpp>
+#include <dze/function_arena.hpp>
+#include <dze/function_batch.hpp>
+#include <dze/function_queue.hpp>
+#include <dze/function_ref.hpp>
+#include <dze/inplace_function.hpp>
+#include <dze/pool_allocator.hpp>
+#include <dze/thread_pool.hpp>
+#include <dze/trivially_relocatable.hpp>
 
 #include "objects.hpp"
 
@@ -58,6 +78,15 @@ void captureless_dze_function(benchmark::State& state)
     }
 }
 
+void captureless_dze_function_ref(benchmark::State& state)
+{
+    for ([[maybe_unused]] auto _ : state)
+    {
+        dze::function_ref<int&(int&)> f = get_captureless_function();
+        benchmark::DoNotOptimize(f(x));
+    }
+}
+
 void captureless_dze_pmr_function(benchmark::State& state)
 {
     std::vector<dze::pmr::function<int&(int&)>> v(iterations);
@@ -121,6 +150,30 @@ void capture_dze_function(benchmark::State& state)
     }
 }
 
+void capture_dze_inplace_function(benchmark::State& state)
+{
+    std::vector<dze::inplace_function<int&()>> v(iterations);
+    auto it = v.begin();
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        auto& f = *it++ = get_function_object(x);
+        benchmark::DoNotOptimize(f());
+    }
+}
+
+void capture_dze_function_ref(benchmark::State& state)
+{
+    std::vector<capture> v(iterations);
+    auto it = v.begin();
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        dze::function_ref<int&() const> f = *it++ = get_function_object(x);
+        benchmark::DoNotOptimize(f());
+    }
+}
+
 void capture_dze_pmr_function(benchmark::State& state)
 {
     std::vector<dze::pmr::function<int&()>> v(iterations);
@@ -266,17 +319,873 @@ void random_pick_dze_pmr_function_with_monotonic_buffer_resource(benchmark::Stat
     }
 }
 
+template <typename Function, typename Callable>
+void move_function(benchmark::State& state, Callable call)
+{
+    Function f1 = std::move(call);
+    Function f2;
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        f2 = std::move(f1);
+        f1 = std::move(f2);
+        benchmark::DoNotOptimize(f1);
+    }
+}
+
+// Fits inline, but its move constructor copies all of it.
+struct expensive_move_capture
+{
+    int* x;
+    std::array<int, 14> nums{};
+
+    explicit expensive_move_capture(int& x_) noexcept
+        : x{&x_} {}
+
+    expensive_move_capture(expensive_move_capture&& other) noexcept
+        : x{other.x}
+        , nums{other.nums} {}
+
+    expensive_move_capture(const expensive_move_capture&) = delete;
+    expensive_move_capture& operator=(const expensive_move_capture&) = delete;
+    expensive_move_capture& operator=(expensive_move_capture&&) = delete;
+
+    ~expensive_move_capture() {} // NOLINT(modernize-use-equals-default)
+
+    int& operator()() const { return *x += nums[0]; }
+};
+
+void move_dze_function_expensive_move(benchmark::State& state)
+{
+    move_function<dze::function<int&()>>(state, expensive_move_capture{x});
+}
+
+// Same callable, stored in allocated memory, so only the pointer to it is moved.
+void move_dze_function_expensive_move_allocated(benchmark::State& state)
+{
+    dze::function<int&()> f1{dze::allocated, expensive_move_capture{x}};
+    dze::function<int&()> f2;
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        f2 = std::move(f1);
+        f1 = std::move(f2);
+        benchmark::DoNotOptimize(f1);
+    }
+}
+
+// A callback made as a noexcept function with another allocator, passed on as a function
+// without noexcept and with the default allocator.
+void convert_dze_function(benchmark::State& state)
+{
+    for ([[maybe_unused]] auto _ : state)
+    {
+        dze::pmr::function<int&() noexcept> f1 = get_noexcept_function_object(x);
+        dze::function<int&()> f2 = std::move(f1);
+        benchmark::DoNotOptimize(f2());
+    }
+}
+
+void call_converted_dze_function(benchmark::State& state)
+{
+    dze::pmr::function<int&() noexcept> f1 = get_noexcept_function_object(x);
+    dze::function<int&()> f2 = std::move(f1);
+
+    for ([[maybe_unused]] auto _ : state)
+        benchmark::DoNotOptimize(f2());
+}
+
+template <typename Function, typename Callable>
+void swap_function(benchmark::State& state, Callable call1, Callable call2)
+{
+    Function f1 = std::move(call1);
+    Function f2 = std::move(call2);
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        f1.swap(f2);
+        benchmark::DoNotOptimize(f1);
+    }
+}
+
+template <typename Function, typename Callable>
+void copy_function(benchmark::State& state, Callable call)
+{
+    Function f1 = std::move(call);
+    Function f2;
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        f2 = f1;
+        benchmark::DoNotOptimize(f2);
+    }
+}
+
+void move_std_function(benchmark::State& state)
+{
+    move_function<std::function<int&()>>(state, get_function_object(x));
+}
+
+void move_dze_function(benchmark::State& state)
+{
+    move_function<dze::function<int&()>>(state, get_function_object(x));
+}
+
+void move_dze_function_not_trivially_copyable(benchmark::State& state)
+{
+    move_function<dze::function<int&()>>(state, get_non_trivial_function_object(x));
+}
+
+void swap_std_function(benchmark::State& state)
+{
+    swap_function<std::function<int&()>>(
+        state, get_function_object(x), get_function_object(x));
+}
+
+void swap_dze_function(benchmark::State& state)
+{
+    swap_function<dze::function<int&()>>(
+        state, get_function_object(x), get_function_object(x));
+}
+
+void swap_dze_function_not_trivially_copyable(benchmark::State& state)
+{
+    swap_function<dze::function<int&()>>(
+        state, get_non_trivial_function_object(x), get_non_trivial_function_object(x));
+}
+
+void copy_std_function(benchmark::State& state)
+{
+    copy_function<std::function<int&()>>(state, get_function_object(x));
+}
+
+void copy_dze_copyable_function(benchmark::State& state)
+{
+    copy_function<dze::copyable_function<int&()>>(state, get_function_object(x));
+}
+
+template <size_t Capacity, size_t CaptureSize>
+void capture_size_sweep(benchmark::State& state)
+{
+    std::vector<dze::basic_function<int&(), Capacity, alignof(std::max_align_t)>> v(iterations);
+    auto it = v.begin();
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        auto& f = *it++ = get_sized_function_object<CaptureSize>(x);
+        benchmark::DoNotOptimize(f());
+    }
+}
+
+enum class layout_op { construct, move, call, destroy };
+
+// Runs one operation on each function of an array of state.range(0) functions, to compare
+// how well layouts line up with cache lines when the array does not fit in L1 or L2.
+template <typename Function, layout_op Op>
+void layout_matrix(benchmark::State& state)
+{
+    const auto count = static_cast<size_t>(state.range(0));
+    std::vector<Function> v1;
+    std::vector<Function> v2(count);
+    v1.reserve(count);
+    for (size_t i = 0; i != count; ++i)
+        v1.emplace_back(get_sized_function_object<16>(x));
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        if constexpr (Op == layout_op::construct)
+        {
+            state.PauseTiming();
+            v1.clear();
+            state.ResumeTiming();
+            for (size_t i = 0; i != count; ++i)
+                v1.emplace_back(get_sized_function_object<16>(x));
+        }
+        else if constexpr (Op == layout_op::move)
+        {
+            for (size_t i = 0; i != count; ++i)
+                v2[i] = std::move(v1[i]);
+            v1.swap(v2);
+        }
+        else if constexpr (Op == layout_op::call)
+        {
+            for (auto& f : v1)
+                benchmark::DoNotOptimize(f());
+        }
+        else
+        {
+            v1.clear();
+            state.PauseTiming();
+            for (size_t i = 0; i != count; ++i)
+                v1.emplace_back(get_sized_function_object<16>(x));
+            state.ResumeTiming();
+        }
+        benchmark::DoNotOptimize(v1.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(count));
+    state.SetBytesProcessed(
+        state.iterations() * static_cast<int64_t>(count * sizeof(Function)));
+}
+
+// Callables whose call operators can be inlined.
+struct scale
+{
+    int factor;
+
+    int operator()(const int i) const noexcept { return i * factor; }
+};
+
+struct offset
+{
+    int addend;
+
+    int operator()(const int i) const noexcept { return i + addend; }
+};
+
+// Sums the results of functions that store a scale, or an offset if Miss, called with
+// operator() or with call_if<scale>.
+template <bool Guarded, bool Miss>
+void guarded_call(benchmark::State& state)
+{
+    std::vector<dze::function<int(int) const>> v(1024);
+    for (auto& f : v)
+    {
+        if constexpr (Miss)
+            f = offset{x};
+        else
+            f = scale{x};
+    }
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        int sum = 0;
+        int i = 0;
+        for (auto& f : v)
+        {
+            if constexpr (Guarded)
+                sum += dze::call_if<scale>(f, i++);
+            else
+                sum += f(i++);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * v.size()));
+}
+
+// Callback of a frame loop. Callbacks of odd I do not fit inline.
+template <size_t I>
+struct frame_callback
+{
+    float total = 0;
+    std::array<float, I % 2 == 0 ? 1 : 32> state = {};
+
+    void operator()(const float dt) { total += dt * static_cast<float>(I + 1) + state[0]; }
+};
+
+constexpr size_t max_frame_callback_kinds = 64;
+
+template <typename Function, size_t... Is>
+std::vector<Function> get_frame_callbacks(const size_t kinds, std::index_sequence<Is...>)
+{
+    using push_t = void(std::vector<Function>&);
+    static constexpr push_t* pushes[] = {
+        [] (std::vector<Function>& v) { v.emplace_back(frame_callback<Is>{}); }...};
+
+    std::mt19937 gen{42};
+    std::uniform_int_distribution<size_t> kind{0, kinds - 1};
+    std::vector<Function> v;
+    v.reserve(50000);
+    for (size_t i = 0; i != 50000; ++i)
+        pushes[kind(gen)](v);
+    // Scatters the allocated callables, which were allocated in order.
+    std::shuffle(v.begin(), v.end(), gen);
+    return v;
+}
+
+enum class frame_loop
+{
+    loop,
+    invoke_all,
+    grouped,
+};
+
+// Calls 50000 callbacks of state.range(0) types in random order.
+template <typename Function, frame_loop Loop>
+void frame_callbacks(benchmark::State& state)
+{
+    auto v = get_frame_callbacks<Function>(
+        static_cast<size_t>(state.range(0)),
+        std::make_index_sequence<max_frame_callback_kinds>{});
+    if constexpr (Loop == frame_loop::grouped)
+        dze::group_by_stub(v);
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        if constexpr (Loop == frame_loop::loop)
+        {
+            for (auto& f : v)
+                f(0.5f);
+        }
+        else
+            dze::invoke_all(v, 0.5f);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * v.size()));
+}
+
+// Calls callables of many_types_count distinct types in random order, see get_many_types.
+template <typename Function>
+void many_types(benchmark::State& state)
+{
+    std::vector<Function> v;
+    get_many_types(v, x);
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        for (auto& f : v)
+            benchmark::DoNotOptimize(f());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * v.size()));
+}
+
+// Reassigns one function with callables that fit inline and callables that do not, like
+// a reusable timer slot.
+template <bool Reserve>
+void reassign_slot(benchmark::State& state)
+{
+    dze::function<int&()> f;
+    if constexpr (Reserve)
+        f.reserve(sizeof(sized_capture<128>));
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        f = get_sized_function_object<16>(x);
+        benchmark::DoNotOptimize(f());
+        f = get_sized_function_object<128>(x);
+        benchmark::DoNotOptimize(f());
+    }
+}
+
+// Minimal vector that relocates its elements with dze::uninitialized_relocate, for
+// comparison with std::vector, which moves each element and destroys the original.
+template <typename T>
+class relocating_vector
+{
+public:
+    relocating_vector() = default;
+    relocating_vector(const relocating_vector&) = delete;
+    relocating_vector& operator=(const relocating_vector&) = delete;
+
+    ~relocating_vector()
+    {
+        std::destroy(m_data, m_data + m_size);
+        m_alloc.deallocate(m_data, m_capacity);
+    }
+
+    template <typename... Args>
+    void emplace_back(Args&&... args)
+    {
+        if (m_size == m_capacity)
+            grow();
+        ::new (m_data + m_size) T{std::forward<Args>(args)...};
+        ++m_size;
+    }
+
+    template <typename... Args>
+    T* emplace(T* const pos, Args&&... args)
+    {
+        const auto index = static_cast<size_t>(pos - m_data);
+        if (m_size == m_capacity)
+            grow();
+        dze::uninitialized_relocate_backward(
+            m_data + index, m_data + m_size, m_data + m_size + 1);
+        ::new (m_data + index) T{std::forward<Args>(args)...};
+        ++m_size;
+        return m_data + index;
+    }
+
+    T* erase(T* const pos) noexcept
+    {
+        pos->~T();
+        dze::uninitialized_relocate(pos + 1, m_data + m_size, pos);
+        --m_size;
+        return pos;
+    }
+
+    [[nodiscard]] T* begin() noexcept { return m_data; }
+
+    [[nodiscard]] T* data() noexcept { return m_data; }
+
+private:
+    std::allocator<T> m_alloc;
+    T* m_data = nullptr;
+    size_t m_size = 0;
+    size_t m_capacity = 0;
+
+    void grow()
+    {
+        const size_t capacity = m_capacity == 0 ? 1 : 2 * m_capacity;
+        T* const data = m_alloc.allocate(capacity);
+        dze::uninitialized_relocate(m_data, m_data + m_size, data);
+        m_alloc.deallocate(m_data, m_capacity);
+        m_data = data;
+        m_capacity = capacity;
+    }
+};
+
+// Appends state.range(0) functions, one in eight of them not trivially relocatable.
+template <typename Vector>
+void vector_growth(benchmark::State& state)
+{
+    const auto count = static_cast<size_t>(state.range(0));
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        Vector v;
+        for (size_t i = 0; i != count; ++i)
+        {
+            if (i % 8 == 0)
+                v.emplace_back(get_non_trivial_function_object(x));
+            else
+                v.emplace_back(get_function_object(x));
+        }
+        benchmark::DoNotOptimize(v.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(count));
+}
+
+// Inserts a function at the front of state.range(0) functions and erases it.
+template <typename Vector>
+void vector_insert_erase_front(benchmark::State& state)
+{
+    Vector v;
+    for (int64_t i = 0; i != state.range(0); ++i)
+        v.emplace_back(get_function_object(x));
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        v.emplace(v.begin(), get_function_object(x));
+        v.erase(v.begin());
+        benchmark::DoNotOptimize(v.data());
+    }
+}
+
+// Bounded queue of functions protected by a mutex, for comparison with dze::function_queue.
+template <typename Function>
+class locked_queue
+{
+public:
+    explicit locked_queue(const size_t capacity)
+        : m_capacity{capacity} {}
+
+    bool try_push(Function&& f)
+    {
+        std::lock_guard lock{m_mutex};
+        if (m_queue.size() == m_capacity)
+            return false;
+
+        m_queue.push_back(std::move(f));
+        return true;
+    }
+
+    std::optional<Function> try_pop()
+    {
+        std::lock_guard lock{m_mutex};
+        if (m_queue.empty())
+            return std::nullopt;
+
+        std::optional<Function> result{std::move(m_queue.front())};
+        m_queue.pop_front();
+        return result;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::deque<Function> m_queue;
+    const size_t m_capacity;
+};
+
+// Every thread pushes a task, then pops a task and runs it.
+// The queue is shared by all the threads of a run and is empty between runs.
+template <typename Queue>
+void queue_throughput(benchmark::State& state)
+{
+    static Queue queue{1024};
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        while (!queue.try_push([i = 0] () mutable { benchmark::DoNotOptimize(++i); }))
+            std::this_thread::yield();
+
+        decltype(queue.try_pop()) f;
+        while (!(f = queue.try_pop()))
+            std::this_thread::yield();
+        (*f)();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Thread pool with a single queue shared by all the threads.
+class locked_pool
+{
+public:
+    explicit locked_pool(const size_t threads)
+    {
+        for (size_t i = 0; i != threads; ++i)
+            m_threads.emplace_back([this] { run(); });
+    }
+
+    locked_pool(const locked_pool&) = delete;
+    locked_pool& operator=(const locked_pool&) = delete;
+
+    ~locked_pool()
+    {
+        {
+            std::lock_guard lock{m_mutex};
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+
+        for (auto& t : m_threads)
+            t.join();
+    }
+
+    template <typename Callable>
+    void submit(Callable&& call)
+    {
+        {
+            std::lock_guard lock{m_mutex};
+            m_tasks.emplace_back(std::forward<Callable>(call));
+        }
+        m_wake.notify_one();
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::deque<dze::function<void() noexcept>> m_tasks;
+    bool m_stopping = false;
+    std::vector<std::thread> m_threads;
+
+    void run()
+    {
+        for (;;)
+        {
+            dze::function<void() noexcept> task;
+            {
+                std::unique_lock lock{m_mutex};
+                m_wake.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+                if (m_tasks.empty())
+                    return;
+
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            task();
+        }
+    }
+};
+
+void wait_for(const std::atomic<int>& counter, const int value)
+{
+    while (counter.load(std::memory_order_acquire) != value)
+        std::this_thread::yield();
+}
+
+template <typename Pool>
+void fan_out(Pool& pool, std::atomic<int>& leaves, const int depth) noexcept
+{
+    if (depth == 0)
+    {
+        benchmark::DoNotOptimize(leaves.fetch_add(1, std::memory_order_release));
+        return;
+    }
+
+    for (int i = 0; i != 2; ++i)
+        pool.submit([&pool, &leaves, depth] () noexcept { fan_out(pool, leaves, depth - 1); });
+}
+
+// Each task submits two tasks until the tree has 1024 leaves. Arg is the thread count.
+template <typename Pool>
+void fork_join(benchmark::State& state)
+{
+    constexpr int depth = 10;
+    Pool pool{static_cast<size_t>(state.range(0))};
+    std::atomic<int> leaves;
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        leaves = 0;
+        pool.submit([&pool, &leaves] () noexcept { fan_out(pool, leaves, depth); });
+        wait_for(leaves, 1 << depth);
+    }
+    state.SetItemsProcessed(state.iterations() * ((2 << depth) - 1));
+}
+
+// The benchmark thread submits many tasks which do next to nothing.
+// Arg is the thread count.
+template <typename Pool>
+void small_tasks(benchmark::State& state)
+{
+    constexpr int tasks = 10000;
+    Pool pool{static_cast<size_t>(state.range(0))};
+    std::atomic<int> done;
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        done = 0;
+        for (int i = 0; i != tasks; ++i)
+        {
+            pool.submit([&done] () noexcept
+            {
+                done.fetch_add(1, std::memory_order_release);
+            });
+        }
+        wait_for(done, tasks);
+    }
+    state.SetItemsProcessed(state.iterations() * tasks);
+}
+
+// Handlers of events of different kinds, either one function per kind, each with a copy of
+// the visitor, or one function with all the signatures.
+struct separate_handlers
+{
+    dze::function<int&(int) const> on_int;
+    dze::function<int&(double) const> on_double;
+    dze::function<int&(const std::string&) const> on_string;
+
+    explicit separate_handlers(const visitor& v)
+        : on_int{v}
+        , on_double{v}
+        , on_string{v} {}
+
+    int& operator()(const int i) const { return on_int(i); }
+    int& operator()(const double d) const { return on_double(d); }
+    int& operator()(const std::string& s) const { return on_string(s); }
+};
+
+struct overloaded_handler
+{
+    dze::function<dze::overloads<
+        int&(int) const, int&(double) const, int&(const std::string&) const>> on_event;
+
+    explicit overloaded_handler(const visitor& v)
+        : on_event{v} {}
+
+    template <typename T>
+    int& operator()(const T& t) const { return on_event(t); }
+};
+
+// Creates a handler and dispatches a few events of each kind to it.
+template <typename Handler>
+void dispatch_events(benchmark::State& state)
+{
+    const std::string s = "event";
+    for ([[maybe_unused]] auto _ : state)
+    {
+        Handler h{get_visitor(x)};
+        benchmark::DoNotOptimize(&h);
+        for (int i = 0; i != 4; ++i)
+        {
+            benchmark::DoNotOptimize(h(i));
+            benchmark::DoNotOptimize(h(0.5 * i));
+            benchmark::DoNotOptimize(h(s));
+        }
+    }
+    state.counters["bytes"] = sizeof(Handler);
+}
+
+// Passes a by value argument through the function and gets it back, so that only the
+// moves of the argument are measured.
+template <typename Function, typename T>
+void pass_by_value(benchmark::State& state, T arg)
+{
+    Function f = [] (T t) { return t; };
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        arg = f(std::move(arg));
+        benchmark::DoNotOptimize(arg);
+    }
+}
+
+void string_argument_std_function(benchmark::State& state)
+{
+    pass_by_value<std::function<std::string(std::string)>>(state, std::string(64, 'a'));
+}
+
+void string_argument_dze_function(benchmark::State& state)
+{
+    pass_by_value<dze::function<std::string(std::string)>>(state, std::string(64, 'a'));
+}
+
+void vector_argument_std_function(benchmark::State& state)
+{
+    pass_by_value<std::function<std::vector<int>(std::vector<int>)>>(
+        state, std::vector<int>(64));
+}
+
+void vector_argument_dze_function(benchmark::State& state)
+{
+    pass_by_value<dze::function<std::vector<int>(std::vector<int>)>>(
+        state, std::vector<int>(64));
+}
+
+// Constructs a callable that does not fit inline from its captures, either as a
+// temporary that is moved into the function, or in place.
+void construct_large_by_value(benchmark::State& state)
+{
+    std::array<int, 64> nums{};
+    for ([[maybe_unused]] auto _ : state)
+    {
+        dze::function<int&(size_t)> f{capture3{x, nums}};
+        benchmark::DoNotOptimize(f(0));
+    }
+}
+
+void construct_large_in_place(benchmark::State& state)
+{
+    std::array<int, 64> nums{};
+    for ([[maybe_unused]] auto _ : state)
+    {
+        dze::function<int&(size_t)> f{std::in_place_type<capture3>, x, nums};
+        benchmark::DoNotOptimize(f(0));
+    }
+}
+
+// Same as above, but the allocation of the function is reused.
+void assign_large_by_value(benchmark::State& state)
+{
+    std::array<int, 64> nums{};
+    dze::function<int&(size_t)> f{capture3{x, nums}};
+    for ([[maybe_unused]] auto _ : state)
+    {
+        f = capture3{x, nums};
+        benchmark::DoNotOptimize(f(0));
+    }
+}
+
+void emplace_large(benchmark::State& state)
+{
+    std::array<int, 64> nums{};
+    dze::function<int&(size_t)> f{capture3{x, nums}};
+    for ([[maybe_unused]] auto _ : state)
+    {
+        f.emplace<capture3>(x, nums);
+        benchmark::DoNotOptimize(f(0));
+    }
+}
+
+// Scopes of request_churn, which give the allocator of the callbacks of a request and
+// are released at the end of each request.
+struct default_scope
+{
+    dze::allocator allocator() const noexcept { return {}; }
+    void release() noexcept {}
+};
+
+struct size_class_pool_scope
+{
+    dze::pool_allocator allocator() const noexcept { return {}; }
+    void release() noexcept {}
+};
+
+struct pool_scope
+{
+    std::pmr::unsynchronized_pool_resource resource;
+
+    dze::polymorphic_allocator allocator() noexcept { return &resource; }
+    void release() noexcept {}
+};
+
+struct monotonic_scope
+{
+    std::pmr::monotonic_buffer_resource resource;
+
+    dze::polymorphic_allocator allocator() noexcept { return &resource; }
+    void release() noexcept { resource.release(); }
+};
+
+struct arena_scope
+{
+    dze::function_arena arena;
+
+    dze::arena_allocator allocator() noexcept { return &arena; }
+    void release() noexcept { arena.release(); }
+};
+
+// Each request builds callbacks, half of which do not fit inline, calls them and
+// destroys them.
+template <typename Function, typename Scope>
+void request_churn(benchmark::State& state)
+{
+    constexpr size_t callbacks = 16;
+
+    Scope scope;
+    std::vector<Function> v;
+    v.reserve(callbacks);
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        for (size_t i = 0; i != callbacks / 2; ++i)
+        {
+            v.emplace_back(get_function_object(x), scope.allocator());
+            v.emplace_back(get_sized_function_object<128>(x), scope.allocator());
+        }
+
+        for (auto& f : v)
+            benchmark::DoNotOptimize(f());
+
+        v.clear();
+        scope.release();
+    }
+    state.SetItemsProcessed(state.iterations() * callbacks);
+}
+
+// Like request_churn, but none of the callbacks fit inline.
+template <typename Function, typename Scope>
+void spill_churn(benchmark::State& state)
+{
+    constexpr size_t callbacks = 15;
+
+    Scope scope;
+    std::vector<Function> v;
+    v.reserve(callbacks);
+
+    for ([[maybe_unused]] auto _ : state)
+    {
+        for (size_t i = 0; i != callbacks / 3; ++i)
+        {
+            v.emplace_back(get_sized_function_object<80>(x), scope.allocator());
+            v.emplace_back(get_sized_function_object<96>(x), scope.allocator());
+            v.emplace_back(get_sized_function_object<128>(x), scope.allocator());
+        }
+
+        for (auto& f : v)
+            benchmark::DoNotOptimize(f());
+
+        v.clear();
+        scope.release();
+    }
+    state.SetItemsProcessed(state.iterations() * callbacks);
+}
+
 } // namespace
 
 BENCHMARK(direct_call)->Iterations(iterations);
 BENCHMARK(function_pointer)->Iterations(iterations);
 BENCHMARK(captureless_std_function)->Iterations(iterations);
 BENCHMARK(captureless_dze_function)->Iterations(iterations);
+BENCHMARK(captureless_dze_function_ref)->Iterations(iterations);
 BENCHMARK(captureless_dze_pmr_function)->Iterations(iterations);
 BENCHMARK(captureless_dze_pmr_function_with_null_memory_resource)->Iterations(iterations);
 BENCHMARK(capture_lambda)->Iterations(iterations);
 BENCHMARK(capture_std_function)->Iterations(iterations);
 BENCHMARK(capture_dze_function)->Iterations(iterations);
+BENCHMARK(capture_dze_inplace_function)->Iterations(iterations);
+BENCHMARK(capture_dze_function_ref)->Iterations(iterations);
 BENCHMARK(capture_dze_pmr_function)->Iterations(iterations);
 BENCHMARK(capture_dze_pmr_function_with_null_memory_resource)->Iterations(iterations);
 BENCHMARK(random_pick_direct_call)->Iterations(iterations);
@@ -287,4 +1196,132 @@ BENCHMARK(random_pick_dze_function_with_monotonic_buffer_resource)->Iterations(i
 BENCHMARK(random_pick_dze_pmr_function)->Iterations(iterations);
 BENCHMARK(random_pick_dze_pmr_function_with_monotonic_buffer_resource)->Iterations(iterations);
 
+BENCHMARK(move_std_function)->Iterations(iterations);
+BENCHMARK(move_dze_function)->Iterations(iterations);
+BENCHMARK(move_dze_function_not_trivially_copyable)->Iterations(iterations);
+BENCHMARK(move_dze_function_expensive_move)->Iterations(iterations);
+BENCHMARK(move_dze_function_expensive_move_allocated)->Iterations(iterations);
+BENCHMARK(convert_dze_function)->Iterations(iterations);
+BENCHMARK(call_converted_dze_function)->Iterations(iterations);
+BENCHMARK(swap_std_function)->Iterations(iterations);
+BENCHMARK(swap_dze_function)->Iterations(iterations);
+BENCHMARK(swap_dze_function_not_trivially_copyable)->Iterations(iterations);
+BENCHMARK(copy_std_function)->Iterations(iterations);
+BENCHMARK(copy_dze_copyable_function)->Iterations(iterations);
+BENCHMARK_TEMPLATE(dispatch_events, separate_handlers)->Iterations(iterations);
+BENCHMARK_TEMPLATE(dispatch_events, overloaded_handler)->Iterations(iterations);
+BENCHMARK(string_argument_std_function)->Iterations(iterations);
+BENCHMARK(string_argument_dze_function)->Iterations(iterations);
+BENCHMARK(vector_argument_std_function)->Iterations(iterations);
+BENCHMARK(vector_argument_dze_function)->Iterations(iterations);
+BENCHMARK(construct_large_by_value)->Iterations(iterations);
+BENCHMARK(construct_large_in_place)->Iterations(iterations);
+BENCHMARK(assign_large_by_value)->Iterations(iterations);
+BENCHMARK(emplace_large)->Iterations(iterations);
+BENCHMARK_TEMPLATE(capture_size_sweep, 16, 8)->Iterations(iterations);
+BENCHMARK_TEMPLATE(capture_size_sweep, 16, 16)->Iterations(iterations);
+BENCHMARK_TEMPLATE(capture_size_sweep, 16, 32)->Iterations(iterations);
+BENCHMARK_TEMPLATE(capture_size_sweep, 16, 64)->Iterations(iterations);
+BENCHMARK_TEMPLATE(capture_size_sweep, 16, 96)->Iterations(iterations);
+BENCHMARK_TEMPLATE(capture_size_sweep, 16, 128)->Iterations(iterations);
+BENCHMARK_TEMPLATE(capture_size_sweep, 32, 8)->Iterations(iterations);
+BENCHMARK_TEMPLATE(capture_size_sweep, 32, 16)->Iterations(iterations);
+BENCHMARK_TEMPLATE(capture_size_sweep, 32, 32)->Iterations(iterations);
+BENCHMARK_TEMPLATE(capture_size_sweep, 32, 64)->Iterations(iterations);
+BENCHMARK_TEMPLATE(capture_size_sweep, 32, 96)->Iterations(iterations);
+BENCHMARK_TEMPLATE(capture_size_sweep, 32, 128)->Iterations(iterations);
+BENCHMARK_TEMPLATE(capture_size_sweep, 64, 8)->Iterations(iterations);
+BENCHMARK_TEMPLATE(capture_size_sweep, 64, 16)->Iterations(iterations);
+BENCHMARK_TEMPLATE(capture_size_sweep, 64, 32)->Iterations(iterations);
+BENCHMARK_TEMPLATE(capture_size_sweep, 64, 64)->Iterations(iterations);
+BENCHMARK_TEMPLATE(capture_size_sweep, 64, 96)->Iterations(iterations);
+BENCHMARK_TEMPLATE(capture_size_sweep, 64, 128)->Iterations(iterations);
+BENCHMARK_TEMPLATE(capture_size_sweep, 128, 8)->Iterations(iterations);
+BENCHMARK_TEMPLATE(capture_size_sweep, 128, 16)->Iterations(iterations);
+BENCHMARK_TEMPLATE(capture_size_sweep, 128, 32)->Iterations(iterations);
+BENCHMARK_TEMPLATE(capture_size_sweep, 128, 64)->Iterations(iterations);
+BENCHMARK_TEMPLATE(capture_size_sweep, 128, 96)->Iterations(iterations);
+BENCHMARK_TEMPLATE(capture_size_sweep, 128, 128)->Iterations(iterations);
+BENCHMARK_TEMPLATE(layout_matrix, dze::function<int&()>, layout_op::construct)
+    ->Arg(1 << 14)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(layout_matrix, dze::function<int&()>, layout_op::move)
+    ->Arg(1 << 14)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(layout_matrix, dze::function<int&()>, layout_op::call)
+    ->Arg(1 << 14)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(layout_matrix, dze::function<int&()>, layout_op::destroy)
+    ->Arg(1 << 14)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(layout_matrix, dze::compact_function<int&()>, layout_op::construct)
+    ->Arg(1 << 14)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(layout_matrix, dze::compact_function<int&()>, layout_op::move)
+    ->Arg(1 << 14)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(layout_matrix, dze::compact_function<int&()>, layout_op::call)
+    ->Arg(1 << 14)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(layout_matrix, dze::compact_function<int&()>, layout_op::destroy)
+    ->Arg(1 << 14)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(layout_matrix, dze::cache_line_function<int&()>, layout_op::construct)
+    ->Arg(1 << 14)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(layout_matrix, dze::cache_line_function<int&()>, layout_op::move)
+    ->Arg(1 << 14)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(layout_matrix, dze::cache_line_function<int&()>, layout_op::call)
+    ->Arg(1 << 14)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(layout_matrix, dze::cache_line_function<int&()>, layout_op::destroy)
+    ->Arg(1 << 14)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(layout_matrix, dze::large_function<int&()>, layout_op::construct)
+    ->Arg(1 << 14)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(layout_matrix, dze::large_function<int&()>, layout_op::move)
+    ->Arg(1 << 14)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(layout_matrix, dze::large_function<int&()>, layout_op::call)
+    ->Arg(1 << 14)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(layout_matrix, dze::large_function<int&()>, layout_op::destroy)
+    ->Arg(1 << 14)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(guarded_call, false, false);
+BENCHMARK_TEMPLATE(guarded_call, true, false);
+BENCHMARK_TEMPLATE(guarded_call, false, true);
+BENCHMARK_TEMPLATE(guarded_call, true, true);
+BENCHMARK_TEMPLATE(frame_callbacks, std::function<void(float)>, frame_loop::loop)
+    ->Arg(1)->Arg(8)->Arg(64);
+BENCHMARK_TEMPLATE(frame_callbacks, dze::function<void(float)>, frame_loop::loop)
+    ->Arg(1)->Arg(8)->Arg(64);
+BENCHMARK_TEMPLATE(frame_callbacks, dze::function<void(float)>, frame_loop::invoke_all)
+    ->Arg(1)->Arg(8)->Arg(64);
+BENCHMARK_TEMPLATE(frame_callbacks, dze::function<void(float)>, frame_loop::grouped)
+    ->Arg(1)->Arg(8)->Arg(64);
+BENCHMARK_TEMPLATE(many_types, std::function<int&()>);
+BENCHMARK_TEMPLATE(many_types, dze::function<int&()>);
+BENCHMARK_TEMPLATE(many_types, dze::copyable_function<int&()>);
+BENCHMARK_TEMPLATE(reassign_slot, false)->Iterations(iterations);
+BENCHMARK_TEMPLATE(reassign_slot, true)->Iterations(iterations);
+BENCHMARK_TEMPLATE(vector_growth, std::vector<dze::function<int&()>>)
+    ->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(vector_growth, relocating_vector<dze::function<int&()>>)
+    ->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(vector_insert_erase_front, std::vector<dze::function<int&()>>)
+    ->Arg(1 << 8)->Arg(1 << 12);
+BENCHMARK_TEMPLATE(vector_insert_erase_front, relocating_vector<dze::function<int&()>>)
+    ->Arg(1 << 8)->Arg(1 << 12);
+BENCHMARK_TEMPLATE(queue_throughput, locked_queue<dze::function<void()>>)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(queue_throughput, dze::function_queue<dze::function<void()>>)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(fork_join, locked_pool)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(fork_join, dze::thread_pool<>)
+    ->RangeMultiplier(2)
+    ->Range(1, 8)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(small_tasks, locked_pool)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(small_tasks, dze::thread_pool<>)
+    ->RangeMultiplier(2)
+    ->Range(1, 8)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(request_churn, dze::function<int&()>, default_scope);
+BENCHMARK_TEMPLATE(request_churn, dze::pmr::function<int&()>, pool_scope);
+BENCHMARK_TEMPLATE(request_churn, dze::pmr::function<int&()>, monotonic_scope);
+BENCHMARK_TEMPLATE(request_churn, dze::arena::function<int&()>, arena_scope);
+BENCHMARK_TEMPLATE(spill_churn, dze::function<int&()>, default_scope);
+BENCHMARK_TEMPLATE(spill_churn, dze::pmr::function<int&()>, pool_scope);
+BENCHMARK_TEMPLATE(
+    spill_churn, dze::function<int&(), dze::pool_allocator>, size_class_pool_scope);
+
 BENCHMARK_MAIN();
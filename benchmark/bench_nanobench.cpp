@@ -1,14 +1,269 @@
+#include <algorithm>
 #include <array>
 #include <functional>
 #include <numeric>
 #include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <vector>
 
 #include <nanobench.h>
 
+#include <dze/copyable_function.hpp>
 #include <dze/function.hpp>
+#include <dze/function_ref.hpp>
+#include <dze/function_vector.hpp>
 
 #include "objects.hpp"
 
+namespace {
+
+template <size_t Capacity, size_t... CaptureSizes>
+void bench_capture_sizes(
+    ankerl::nanobench::Bench& bench, const size_t epochs, const size_t iterations, int& x)
+{
+    auto run = [&] (auto capture_size)
+    {
+        std::vector<dze::basic_function<int&(), Capacity, alignof(std::max_align_t)>> v(
+            epochs * iterations);
+        auto it = v.begin();
+        bench.epochs(epochs).epochIterations(iterations).run(
+            "capacity " + std::to_string(Capacity) +
+                ", capture " + std::to_string(decltype(capture_size)::value),
+            [&]
+            {
+                auto& f = *it++ =
+                    get_sized_function_object<decltype(capture_size)::value>(x);
+                ankerl::nanobench::doNotOptimizeAway(f());
+            });
+    };
+
+    (run(std::integral_constant<size_t, CaptureSizes>{}), ...);
+}
+
+// Calls functions that store either a callable that fits inline or one that is allocated,
+// picked at random, so the storage kind of the next call cannot be predicted.
+template <typename Function>
+void bench_inline_allocated_mix(
+    ankerl::nanobench::Bench& bench,
+    const char* const name,
+    const size_t epochs,
+    const size_t iterations,
+    int& x)
+{
+    ankerl::nanobench::Rng rng{0};
+    std::vector<Function> v(1024);
+    for (auto& f : v)
+    {
+        if (rng.bounded(2) == 0)
+            f = get_sized_function_object<16>(x);
+        else
+            f = get_sized_function_object<128>(x);
+    }
+
+    bench.epochs(epochs).epochIterations(iterations).run(
+        name,
+        [&]
+        {
+            ankerl::nanobench::doNotOptimizeAway(v[rng.bounded(v.size())]());
+        });
+}
+
+// Adds callables of 8, 16, 32 and 64 bytes, picked at random, to a callback list.
+template <typename Push>
+void fill_callback_list(const size_t count, int& x, Push push)
+{
+    ankerl::nanobench::Rng rng{0};
+    for (size_t i = 0; i != count; ++i)
+    {
+        switch (rng.bounded(4))
+        {
+        case 0: push(get_sized_function_object<8>(x)); break;
+        case 1: push(get_sized_function_object<16>(x)); break;
+        case 2: push(get_sized_function_object<32>(x)); break;
+        default: push(get_sized_function_object<64>(x)); break;
+        }
+    }
+}
+
+// Rebuilds a callback list, then invokes every callable of it.
+template <typename List, typename Push, typename Call>
+void bench_callback_list(
+    ankerl::nanobench::Bench& bench,
+    const std::string& name,
+    const size_t count,
+    int& x,
+    Push push,
+    Call call)
+{
+    List list;
+    bench.run(
+        name + ", build " + std::to_string(count),
+        [&]
+        {
+            list.clear();
+            fill_callback_list(count, x, [&] (auto f) { push(list, std::move(f)); });
+            ankerl::nanobench::doNotOptimizeAway(list);
+        });
+
+    bench.run(
+        name + ", call " + std::to_string(count),
+        [&]
+        {
+            call(list);
+            ankerl::nanobench::doNotOptimizeAway(x);
+        });
+}
+
+void bench_callback_lists(
+    ankerl::nanobench::Bench& bench,
+    const size_t epochs,
+    const size_t iterations,
+    const size_t count,
+    int& x)
+{
+    bench.epochs(epochs).epochIterations(std::max<size_t>(1, iterations * 64 / count))
+        .batch(static_cast<double>(count));
+
+    auto emplace_back = [] (auto& list, auto f) { list.emplace_back(std::move(f)); };
+    auto call_each = [] (auto& list)
+    {
+        for (auto& f : list)
+            f();
+    };
+
+    bench_callback_list<std::vector<std::function<int&()>>>(
+        bench, "std::vector<std::function>", count, x, emplace_back, call_each);
+    bench_callback_list<std::vector<dze::function<int&()>>>(
+        bench, "std::vector<dze::function>", count, x, emplace_back, call_each);
+    bench_callback_list<dze::function_vector<int&()>>(
+        bench,
+        "dze::function_vector",
+        count,
+        x,
+        [] (auto& list, auto f) { list.push_back(std::move(f)); },
+        [] (auto& list) { list(); });
+
+    bench.batch(1);
+}
+
+// Counts the allocations made through it.
+class counting_resource : public std::pmr::memory_resource
+{
+public:
+    size_t allocations = 0;
+
+private:
+    void* do_allocate(const size_t bytes, const size_t alignment) override
+    {
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* const p, const size_t bytes, const size_t alignment) override
+    {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+// Constructs functions from callables of common capture sizes and reports how many of
+// them dze::function stores inline.
+template <size_t... CaptureSizes>
+void bench_fit_rate(
+    ankerl::nanobench::Bench& bench, const size_t epochs, const size_t iterations, int& x)
+{
+    size_t fits = 0;
+    auto run = [&] (auto capture_size)
+    {
+        constexpr size_t size = decltype(capture_size)::value;
+
+        counting_resource resource;
+        {
+            dze::pmr::function<int&()> f{get_sized_function_object<size>(x), &resource};
+            ankerl::nanobench::doNotOptimizeAway(f());
+        }
+        const bool is_inline = resource.allocations == 0;
+        fits += is_inline;
+
+        bench.epochs(epochs).epochIterations(iterations).run(
+            "std::function, capture " + std::to_string(size),
+            [&]
+            {
+                std::function<int&()> f = get_sized_function_object<size>(x);
+                ankerl::nanobench::doNotOptimizeAway(f());
+            });
+
+        bench.epochs(epochs).epochIterations(iterations).run(
+            "dze::function, capture " + std::to_string(size) +
+                (is_inline ? ", inline" : ", allocated"),
+            [&]
+            {
+                dze::function<int&()> f = get_sized_function_object<size>(x);
+                ankerl::nanobench::doNotOptimizeAway(f());
+            });
+    };
+
+    (run(std::integral_constant<size_t, CaptureSizes>{}), ...);
+
+    std::cout << "dze::function (" << sizeof(dze::function<int&()>) << " bytes) stores "
+              << fits << " of " << sizeof...(CaptureSizes) << " capture sizes inline\n";
+}
+
+// Constructs, moves, calls and destroys each function of arrays bigger than the L2 cache,
+// one function per iteration, to compare how well layouts line up with cache lines.
+template <typename Function>
+void bench_layout(
+    ankerl::nanobench::Bench& bench,
+    const std::string& name,
+    const size_t epochs,
+    const size_t iterations,
+    int& x)
+{
+    const size_t count = epochs * iterations;
+    const std::string prefix = name + " (" + std::to_string(sizeof(Function)) + " bytes), ";
+    bench.epochs(epochs).epochIterations(iterations);
+
+    std::allocator<Function> alloc;
+    Function* const raw = alloc.allocate(count);
+    size_t i = 0;
+    bench.run(
+        prefix + "construct",
+        [&]
+        {
+            auto& f = *::new (raw + i++) Function{get_sized_function_object<16>(x)};
+            ankerl::nanobench::doNotOptimizeAway(f);
+        });
+
+    std::vector<Function> v(count);
+    i = 0;
+    bench.run(
+        prefix + "move",
+        [&]
+        {
+            auto& f = v[i] = std::move(raw[i]);
+            ++i;
+            ankerl::nanobench::doNotOptimizeAway(f);
+        });
+
+    i = 0;
+    bench.run(prefix + "call", [&] { ankerl::nanobench::doNotOptimizeAway(v[i++]()); });
+
+    for (i = 0; i != count; ++i)
+        raw[i] = std::move(v[i]);
+
+    i = 0;
+    bench.run(prefix + "destroy", [&] { raw[i++].~Function(); });
+    alloc.deallocate(raw, count);
+}
+
+} // namespace
+
 int main()
 {
     constexpr size_t epochs = 4 * 128;
@@ -59,6 +314,14 @@ int main()
             });
     }
 
+    bench.epochs(epochs).epochIterations(iterations).run(
+        "dze::function_ref",
+        [&]
+        {
+            dze::function_ref<int&(int&)> f = get_captureless_function();
+            ankerl::nanobench::doNotOptimizeAway(f(x));
+        });
+
     {
         std::vector<dze::pmr::function<int&(int&)>> v(epochs * iterations);
         auto it = v.begin();
@@ -128,6 +391,18 @@ int main()
             });
     }
 
+    {
+        std::vector<capture> v(epochs * iterations);
+        auto it = v.begin();
+        bench.epochs(epochs).epochIterations(iterations).run(
+            "dze::function_ref",
+            [&]
+            {
+                dze::function_ref<int&() const> f = *it++ = get_function_object(x);
+                ankerl::nanobench::doNotOptimizeAway(f());
+            });
+    }
+
     {
         std::vector<dze::pmr::function<int&()>> v(epochs * iterations);
         auto it = v.begin();
@@ -267,4 +542,212 @@ int main()
                 mr.release();
             });
     }
+
+    bench.title("call");
+
+    {
+        std::function<int&(int&)> f = get_captureless_function();
+        bench.epochs(epochs).epochIterations(iterations).run(
+            "std::function, captureless",
+            [&] { ankerl::nanobench::doNotOptimizeAway(f(x)); });
+    }
+
+    {
+        dze::function<int&(int&)> f = get_captureless_function();
+        bench.epochs(epochs).epochIterations(iterations).run(
+            "dze::function, captureless",
+            [&] { ankerl::nanobench::doNotOptimizeAway(f(x)); });
+    }
+
+    {
+        std::function<int&()> f = get_function_object(x);
+        bench.epochs(epochs).epochIterations(iterations).run(
+            "std::function, capture",
+            [&] { ankerl::nanobench::doNotOptimizeAway(f()); });
+    }
+
+    {
+        dze::function<int&()> f = get_function_object(x);
+        bench.epochs(epochs).epochIterations(iterations).run(
+            "dze::function, capture",
+            [&] { ankerl::nanobench::doNotOptimizeAway(f()); });
+    }
+
+    {
+        dze::function<int&()> f = get_function_object(x);
+        dze::function_ref<int&()> r = f;
+        bench.epochs(epochs).epochIterations(iterations).run(
+            "dze::function_ref to dze::function, capture",
+            [&] { ankerl::nanobench::doNotOptimizeAway(r()); });
+    }
+
+    {
+        ankerl::nanobench::Rng rng{0};
+        dze::function<int&(size_t)> f = get_function_object(x, nums);
+        bench.epochs(epochs).epochIterations(iterations).run(
+            "dze::function, allocated",
+            [&] { ankerl::nanobench::doNotOptimizeAway(f(rng.bounded(nums.size()))); });
+    }
+
+    bench.title("move");
+
+    {
+        std::function<int&()> f1 = get_function_object(x);
+        std::function<int&()> f2;
+        bench.epochs(epochs).epochIterations(iterations).run(
+            "std::function",
+            [&]
+            {
+                f2 = std::move(f1);
+                f1 = std::move(f2);
+                ankerl::nanobench::doNotOptimizeAway(f1);
+            });
+    }
+
+    {
+        dze::function<int&()> f1 = get_function_object(x);
+        dze::function<int&()> f2;
+        bench.epochs(epochs).epochIterations(iterations).run(
+            "dze::function",
+            [&]
+            {
+                f2 = std::move(f1);
+                f1 = std::move(f2);
+                ankerl::nanobench::doNotOptimizeAway(f1);
+            });
+    }
+
+    {
+        dze::function<int&()> f1 = get_non_trivial_function_object(x);
+        dze::function<int&()> f2;
+        bench.epochs(epochs).epochIterations(iterations).run(
+            "dze::function, not trivially copyable",
+            [&]
+            {
+                f2 = std::move(f1);
+                f1 = std::move(f2);
+                ankerl::nanobench::doNotOptimizeAway(f1);
+            });
+    }
+
+    bench.title("swap");
+
+    {
+        std::function<int&()> f1 = get_function_object(x);
+        std::function<int&()> f2 = get_function_object(x);
+        bench.epochs(epochs).epochIterations(iterations).run(
+            "std::function",
+            [&]
+            {
+                f1.swap(f2);
+                ankerl::nanobench::doNotOptimizeAway(f1);
+            });
+    }
+
+    {
+        dze::function<int&()> f1 = get_function_object(x);
+        dze::function<int&()> f2 = get_function_object(x);
+        bench.epochs(epochs).epochIterations(iterations).run(
+            "dze::function",
+            [&]
+            {
+                f1.swap(f2);
+                ankerl::nanobench::doNotOptimizeAway(f1);
+            });
+    }
+
+    {
+        dze::function<int&()> f1 = get_non_trivial_function_object(x);
+        dze::function<int&()> f2 = get_non_trivial_function_object(x);
+        bench.epochs(epochs).epochIterations(iterations).run(
+            "dze::function, not trivially copyable",
+            [&]
+            {
+                f1.swap(f2);
+                ankerl::nanobench::doNotOptimizeAway(f1);
+            });
+    }
+
+    bench.title("copy");
+
+    {
+        std::function<int&()> f1 = get_function_object(x);
+        std::function<int&()> f2;
+        bench.epochs(epochs).epochIterations(iterations).run(
+            "std::function",
+            [&]
+            {
+                f2 = f1;
+                ankerl::nanobench::doNotOptimizeAway(f2);
+            });
+    }
+
+    {
+        dze::copyable_function<int&()> f1 = get_function_object(x);
+        dze::copyable_function<int&()> f2;
+        bench.epochs(epochs).epochIterations(iterations).run(
+            "dze::copyable_function",
+            [&]
+            {
+                f2 = f1;
+                ankerl::nanobench::doNotOptimizeAway(f2);
+            });
+    }
+
+    {
+        std::function<int&(size_t)> f1 = get_function_object(x, nums);
+        std::function<int&(size_t)> f2;
+        bench.epochs(epochs).epochIterations(iterations).run(
+            "std::function, allocated",
+            [&]
+            {
+                f2 = f1;
+                ankerl::nanobench::doNotOptimizeAway(f2);
+            });
+    }
+
+    {
+        dze::copyable_function<int&(size_t)> f1 = get_function_object(x, nums);
+        dze::copyable_function<int&(size_t)> f2;
+        bench.epochs(epochs).epochIterations(iterations).run(
+            "dze::copyable_function, allocated",
+            [&]
+            {
+                f2 = f1;
+                ankerl::nanobench::doNotOptimizeAway(f2);
+            });
+    }
+
+    bench.title("inline and allocated mix");
+
+    bench_inline_allocated_mix<std::function<int&()>>(
+        bench, "std::function", epochs, iterations, x);
+    bench_inline_allocated_mix<dze::function<int&()>>(
+        bench, "dze::function", epochs, iterations, x);
+
+    bench.title("callback list");
+
+    bench_callback_lists(bench, epochs, iterations, 1000, x);
+    bench_callback_lists(bench, epochs, iterations, 100000, x);
+
+    bench.title("capture size sweep");
+
+    bench_capture_sizes<16, 8, 16, 32, 64, 96, 128>(bench, epochs, iterations, x);
+    bench_capture_sizes<32, 8, 16, 32, 64, 96, 128>(bench, epochs, iterations, x);
+    bench_capture_sizes<64, 8, 16, 32, 64, 96, 128>(bench, epochs, iterations, x);
+    bench_capture_sizes<128, 8, 16, 32, 64, 96, 128>(bench, epochs, iterations, x);
+
+    bench.title("inline fit rate");
+
+    bench_fit_rate<8, 16, 24, 32, 40, 48, 56, 64, 72, 80>(bench, epochs, iterations, x);
+
+    bench.title("layout matrix");
+
+    bench_layout<dze::function<int&()>>(bench, "dze::function", epochs, iterations, x);
+    bench_layout<dze::compact_function<int&()>>(
+        bench, "dze::compact_function", epochs, iterations, x);
+    bench_layout<dze::cache_line_function<int&()>>(
+        bench, "dze::cache_line_function", epochs, iterations, x);
+    bench_layout<dze::large_function<int&()>>(
+        bench, "dze::large_function", epochs, iterations, x);
 }
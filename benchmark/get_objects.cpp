@@ -19,9 +19,81 @@ capture get_function_object(int& x)
     return capture{&x};
 }
 
+int& noexcept_capture::operator()() const noexcept { return *x += *x; }
+
+noexcept_capture get_noexcept_function_object(int& x)
+{
+    return noexcept_capture{&x};
+}
+
+int& non_trivial_capture::operator()() const { return *x += *x; }
+
+non_trivial_capture get_non_trivial_function_object(int& x)
+{
+    return non_trivial_capture{&x};
+}
+
 int& capture2::operator()(const size_t idx) { return *x += nums[idx]; }
 
 capture2 get_function_object(int& x, const std::array<int, 64>& nums)
 {
     return capture2{&x, nums};
 }
+
+capture3::capture3(int& x_, const std::array<int, 64>& nums_) noexcept
+    : x{&x_}
+    , nums{nums_} {}
+
+int& capture3::operator()(const size_t idx) { return *x += nums[idx]; }
+
+int& visitor::operator()(const int i) const { return *x += weights[0] * i; }
+
+int& visitor::operator()(const double d) const
+{
+    return *x += weights[1] * static_cast<int>(d);
+}
+
+int& visitor::operator()(const std::string& s) const
+{
+    return *x += weights[2] * static_cast<int>(s.size());
+}
+
+visitor get_visitor(int& x)
+{
+    return visitor{&x, {1, 2, 3, 4, 5, 6, 7, 8}};
+}
+
+template <size_t Size>
+int& sized_capture<Size>::operator()() const { return *x += *x; }
+
+template <size_t Size>
+sized_capture<Size> get_sized_function_object(int& x)
+{
+    return sized_capture<Size>{&x, {}};
+}
+
+template struct sized_capture<8>;
+template struct sized_capture<16>;
+template struct sized_capture<24>;
+template struct sized_capture<32>;
+template struct sized_capture<40>;
+template struct sized_capture<48>;
+template struct sized_capture<56>;
+template struct sized_capture<64>;
+template struct sized_capture<72>;
+template struct sized_capture<80>;
+template struct sized_capture<96>;
+template struct sized_capture<128>;
+
+template sized_capture<8> get_sized_function_object(int&);
+template sized_capture<16> get_sized_function_object(int&);
+template sized_capture<24> get_sized_function_object(int&);
+template sized_capture<32> get_sized_function_object(int&);
+template sized_capture<40> get_sized_function_object(int&);
+template sized_capture<48> get_sized_function_object(int&);
+template sized_capture<56> get_sized_function_object(int&);
+template sized_capture<64> get_sized_function_object(int&);
+template sized_capture<72> get_sized_function_object(int&);
+template sized_capture<80> get_sized_function_object(int&);
+template sized_capture<96> get_sized_function_object(int&);
+template sized_capture<128> get_sized_function_object(int&);
@@ -0,0 +1,55 @@
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <dze/copyable_function.hpp>
+#include <dze/function.hpp>
+
+#include "objects.hpp"
+
+namespace {
+
+// The constant keeps the linker from folding the call operators of different types.
+template <size_t I>
+auto get_kind(int& x) noexcept
+{
+    return [&x] () -> int& { return x += static_cast<int>(I); };
+}
+
+template <typename Function, size_t I>
+void push_kind(std::vector<Function>& v, int& x)
+{
+    v.emplace_back(get_kind<I>(x));
+}
+
+template <typename Function, size_t... Is>
+void get_kinds(std::vector<Function>& v, int& x, std::index_sequence<Is...>)
+{
+    using push_t = void(std::vector<Function>&, int&);
+    static constexpr push_t* pushes[] = {&push_kind<Function, Is>...};
+
+    v.clear();
+    v.reserve(sizeof...(Is));
+    for (auto* const push : pushes)
+        push(v, x);
+    std::shuffle(v.begin(), v.end(), std::mt19937{42});
+}
+
+} // namespace
+
+void get_many_types(std::vector<std::function<int&()>>& v, int& x)
+{
+    get_kinds(v, x, std::make_index_sequence<many_types_count>{});
+}
+
+void get_many_types(std::vector<dze::function<int&()>>& v, int& x)
+{
+    get_kinds(v, x, std::make_index_sequence<many_types_count>{});
+}
+
+void get_many_types(std::vector<dze::copyable_function<int&()>>& v, int& x)
+{
+    get_kinds(v, x, std::make_index_sequence<many_types_count>{});
+}
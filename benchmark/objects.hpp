@@ -1,7 +1,13 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <functional>
+#include <string>
+#include <vector>
+
+#include <dze/copyable_function.hpp>
+#include <dze/function.hpp>
 
 using fff = int&(int&);
 
@@ -16,6 +22,38 @@ struct capture
 
 capture get_function_object(int&);
 
+// Same as capture but noexcept.
+struct noexcept_capture
+{
+    int* x;
+
+    int& operator()() const noexcept;
+};
+
+noexcept_capture get_noexcept_function_object(int&);
+
+// Same as capture but not trivially copyable.
+struct non_trivial_capture
+{
+    int* x;
+
+    explicit non_trivial_capture(int* x_) noexcept
+        : x{x_} {}
+
+    non_trivial_capture(non_trivial_capture&& other) noexcept
+        : x{other.x} {}
+
+    non_trivial_capture(const non_trivial_capture&) = delete;
+    non_trivial_capture& operator=(const non_trivial_capture&) = delete;
+    non_trivial_capture& operator=(non_trivial_capture&&) = delete;
+
+    ~non_trivial_capture() {} // NOLINT(modernize-use-equals-default)
+
+    int& operator()() const;
+};
+
+non_trivial_capture get_non_trivial_function_object(int&);
+
 struct capture2
 {
     int* x;
@@ -25,3 +63,50 @@ struct capture2
 };
 
 capture2 get_function_object(int&, const std::array<int, 64>&);
+
+// Same as capture2 but constructed from its captures, so it can be constructed in place.
+struct capture3
+{
+    int* x;
+    alignas(64) std::array<int, 64> nums;
+
+    capture3(int& x_, const std::array<int, 64>& nums_) noexcept;
+
+    int& operator()(size_t);
+};
+
+// Function object with an overload for each kind of event.
+struct visitor
+{
+    int* x;
+    std::array<int, 8> weights;
+
+    int& operator()(int) const;
+    int& operator()(double) const;
+    int& operator()(const std::string&) const;
+};
+
+visitor get_visitor(int&);
+
+// Function object that is exactly Size bytes.
+template <size_t Size>
+struct sized_capture
+{
+    int* x;
+    std::array<std::byte, Size - sizeof(int*)> padding;
+
+    int& operator()() const;
+};
+
+template <size_t Size>
+sized_capture<Size> get_sized_function_object(int&);
+
+inline constexpr size_t many_types_count = 1024;
+
+// Replaces the contents of the vector with many_types_count callables of distinct
+// types, in random order. Each type has its own call stub, so calling them all stresses the
+// instruction cache. They are instantiated in many_types.cpp only, so the text size of its
+// object file is the build size cost of that many types.
+void get_many_types(std::vector<std::function<int&()>>&, int&);
+void get_many_types(std::vector<dze::function<int&()>>&, int&);
+void get_many_types(std::vector<dze::copyable_function<int&()>>&, int&);
@@ -0,0 +1,384 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <dze/allocator.hpp>
+#include <dze/memory_resource.hpp>
+#include <dze/type_traits.hpp>
+
+#include "function.hpp"
+
+namespace dze {
+
+template <typename, typename>
+class copyable_function;
+
+template <typename>
+struct is_copyable_function : std::false_type {};
+
+template <typename Signature, size_t Size, size_t Align, typename Alloc>
+struct is_copyable_function<basic_copyable_function<Signature, Size, Align, Alloc>>
+    : std::true_type {};
+
+template <typename Signature, typename Alloc>
+struct is_copyable_function<copyable_function<Signature, Alloc>> : std::true_type {};
+
+template <typename T>
+inline constexpr bool is_copyable_function_v = is_copyable_function<T>::value;
+
+// Copyable polymorphic function wrapper.
+// Callables are stored exactly like in basic_function with the same template arguments,
+// so copying a callable that is stored inline never allocates.
+// Only copy constructible callables can be stored.
+template <typename Signature, size_t Size, size_t Align, typename Alloc = allocator>
+class basic_copyable_function : private basic_function<Signature, Size, Align, Alloc>
+{
+    using base = basic_function<Signature, Size, Align, Alloc>;
+    using alloc_traits = std::allocator_traits<Alloc>;
+
+    template <typename Callable>
+    static constexpr bool is_storable_v =
+        std::is_copy_constructible_v<std::decay_t<Callable>> &&
+        base::template is_convertible_v<Callable>;
+
+    static constexpr bool is_nothrow_storable_v = base::is_nothrow_allocatable_v;
+
+    template <typename T, typename... Args>
+    static constexpr bool is_emplaceable_v =
+        std::is_copy_constructible_v<T> && base::template is_emplaceable_v<T, Args...>;
+
+public:
+    using allocator_type = Alloc;
+
+    using base::operator();
+    using base::operator bool;
+    using base::shrink_to_fit;
+    using base::reserve;
+    using base::capacity;
+    using base::is_inline;
+    using base::target;
+    using base::trivially_relocatable;
+
+    basic_copyable_function() noexcept
+        : basic_copyable_function{Alloc{}} {}
+
+    basic_copyable_function(const Alloc& alloc) noexcept
+        : base{alloc} {}
+
+    basic_copyable_function(std::nullptr_t, const Alloc& alloc = Alloc{}) noexcept
+        : base{alloc} {}
+
+    template <typename Callable,
+        DZE_REQUIRES(!is_copyable_function_v<Callable> && is_storable_v<Callable>)>
+    basic_copyable_function(Callable call, const Alloc& alloc = Alloc{})
+        noexcept(is_nothrow_storable_v)
+        : base{std::move(call), alloc, typename base::conv_tag_t{}, std::true_type{}} {}
+
+    // Constructs a T from args directly in its final storage.
+    template <typename T, typename... Args,
+        DZE_REQUIRES(is_emplaceable_v<T, Args...>)>
+    explicit basic_copyable_function(std::in_place_type_t<T>, Args&&... args)
+        noexcept(base::template is_nothrow_emplaceable_v<T, Args...>)
+        : base{Alloc{}}
+    {
+        base::template emplace_impl<T, true>(std::forward<Args>(args)...);
+    }
+
+    template <typename T, typename... Args,
+        DZE_REQUIRES(is_emplaceable_v<T, Args...>)>
+    basic_copyable_function(
+        std::allocator_arg_t, const Alloc& alloc, std::in_place_type_t<T>, Args&&... args)
+        noexcept(base::template is_nothrow_emplaceable_v<T, Args...>)
+        : base{alloc}
+    {
+        base::template emplace_impl<T, true>(std::forward<Args>(args)...);
+    }
+
+    template <typename Callable,
+        DZE_REQUIRES(!is_copyable_function_v<Callable> && is_storable_v<Callable>)>
+    basic_copyable_function(allocated_t, Callable call, const Alloc& alloc = Alloc{})
+        noexcept(is_nothrow_storable_v)
+        : base{alloc}
+    {
+        base::template emplace_impl<Callable, true, true>(std::move(call));
+    }
+
+    template <typename T, typename... Args,
+        DZE_REQUIRES(is_emplaceable_v<T, Args...>)>
+    basic_copyable_function(
+        std::allocator_arg_t,
+        const Alloc& alloc,
+        allocated_t,
+        std::in_place_type_t<T>,
+        Args&&... args)
+        noexcept(std::is_nothrow_constructible_v<T, Args...> && is_nothrow_storable_v)
+        : base{alloc}
+    {
+        base::template emplace_impl<T, true, true>(std::forward<Args>(args)...);
+    }
+
+    template <
+        typename Member,
+        typename Object,
+        typename = decltype(
+            basic_copyable_function{std::mem_fn(std::declval<Member Object::*>())})>
+    // NOLINTNEXTLINE(readability-avoid-const-params-in-decls)
+    basic_copyable_function(Member Object::*const ptr, const Alloc& alloc = Alloc{}) noexcept
+        : base{alloc}
+    {
+        if (ptr)
+            *this = std::mem_fn(ptr);
+    }
+
+    basic_copyable_function(const basic_copyable_function& other)
+        : basic_copyable_function{
+            other, alloc_traits::select_on_container_copy_construction(other.get_allocator())} {}
+
+    basic_copyable_function(const basic_copyable_function& other, const Alloc& alloc)
+        : base{alloc}
+    {
+        base::copy_from(other);
+    }
+
+    template <typename Signature2,
+        DZE_REQUIRES(!std::is_same_v<Signature2, Signature> &&
+            base::template is_movable_v<Signature2>)>
+    basic_copyable_function(const basic_copyable_function<Signature2, Size, Align, Alloc>& other)
+        : base{alloc_traits::select_on_container_copy_construction(other.get_allocator())}
+    {
+        base::copy_from(other);
+    }
+
+    template <typename Signature2 = Signature,
+        DZE_REQUIRES(base::template is_movable_v<Signature2>)>
+    basic_copyable_function(basic_copyable_function<Signature2, Size, Align, Alloc>&& other)
+        noexcept
+        : base{static_cast<basic_function<Signature2, Size, Align, Alloc>&&>(other)} {}
+
+    template <
+        typename Signature2 = Signature,
+        size_t Size2 = Size,
+        size_t Align2 = Align,
+        typename Alloc2 = Alloc,
+        DZE_REQUIRES(
+            !(base::template is_movable_v<Signature2> && Size2 == Size && Align2 == Align &&
+                std::is_same_v<Alloc2, Alloc>) &&
+            is_storable_v<basic_copyable_function<Signature2, Size2, Align2, Alloc2>>)>
+    basic_copyable_function(
+        basic_copyable_function<Signature2, Size2, Align2, Alloc2> other,
+        const Alloc& alloc = Alloc{})
+        noexcept(is_nothrow_storable_v)
+        : base{alloc}
+    {
+        assign_converted(other);
+    }
+
+    // Provides the strong exception guarantee.
+    basic_copyable_function& operator=(const basic_copyable_function& other)
+    {
+        if (this == &other)
+            return *this;
+
+        if constexpr (
+            !alloc_traits::propagate_on_container_copy_assignment::value ||
+            alloc_traits::is_always_equal::value)
+        {
+            if (other.nothrow_copyable())
+            {
+                base::operator=(nullptr);
+                base::copy_from(other);
+                return *this;
+            }
+        }
+
+        *this = basic_copyable_function{
+            other,
+            alloc_traits::propagate_on_container_copy_assignment::value
+                ? other.get_allocator()
+                : get_allocator()};
+        return *this;
+    }
+
+    template <typename Signature2 = Signature,
+        DZE_REQUIRES(base::template is_movable_v<Signature2>)>
+    basic_copyable_function& operator=(
+        basic_copyable_function<Signature2, Size, Align, Alloc>&& other)
+        noexcept(std::is_nothrow_assignable_v<base&, base&&>)
+    {
+        base::operator=(static_cast<basic_function<Signature2, Size, Align, Alloc>&&>(other));
+        return *this;
+    }
+
+    template <
+        typename Signature2 = Signature,
+        size_t Size2 = Size,
+        size_t Align2 = Align,
+        typename Alloc2 = Alloc,
+        DZE_REQUIRES(
+            !(base::template is_movable_v<Signature2> && Size2 == Size && Align2 == Align &&
+                std::is_same_v<Alloc2, Alloc>) &&
+            is_storable_v<basic_copyable_function<Signature2, Size2, Align2, Alloc2>>)>
+    basic_copyable_function& operator=(
+        basic_copyable_function<Signature2, Size2, Align2, Alloc2> other)
+    {
+        assign_converted(other);
+        return *this;
+    }
+
+    // Allocators are exchanged as if by move assignment. When they are not exchanged and do
+    // not compare equal, allocated callables are moved to memory from the other allocator.
+    void swap(basic_copyable_function& other) noexcept(noexcept(this->base::swap(other)))
+    {
+        base::swap(other);
+    }
+
+    basic_copyable_function& operator=(std::nullptr_t) noexcept
+    {
+        base::operator=(nullptr);
+        return *this;
+    }
+
+    template <typename Callable,
+        DZE_REQUIRES(!is_copyable_function_v<Callable> && is_storable_v<Callable>)>
+    basic_copyable_function& operator=(Callable call)
+        noexcept(noexcept(this->template assign<true>(std::move(call))))
+    {
+        base::template assign<true>(std::move(call));
+        return *this;
+    }
+
+    template <
+        typename Member,
+        typename Object,
+        typename = decltype(
+            basic_copyable_function{std::mem_fn(std::declval<Member Object::*>())})>
+    basic_copyable_function& operator=(Member Object::*const ptr) noexcept
+    {
+        *this = ptr ? std::mem_fn(ptr) : nullptr;
+        return *this;
+    }
+
+    // Destroys the stored callable, if any, then constructs a T from args directly in its
+    // final storage. If that throws, this object is left empty.
+    template <typename T, typename... Args,
+        DZE_REQUIRES(is_emplaceable_v<T, Args...>)>
+    T& emplace(Args&&... args) noexcept(base::template is_nothrow_emplaceable_v<T, Args...>)
+    {
+        return base::template emplace_impl<T, true>(std::forward<Args>(args)...);
+    }
+
+private:
+    template <typename, size_t, size_t, typename>
+    friend class basic_copyable_function;
+
+    template <bool, bool, typename, typename...>
+    friend class details::function_ns::ref_base;
+
+    friend struct details::function_ns::batch_access;
+
+    friend bool operator==(const basic_copyable_function& f, std::nullptr_t) noexcept
+    {
+        return !f;
+    }
+
+    friend bool operator==(std::nullptr_t, const basic_copyable_function& f) noexcept
+    {
+        return !f;
+    }
+
+    friend bool operator!=(const basic_copyable_function& f, std::nullptr_t) noexcept
+    {
+        return static_cast<bool>(f);
+    }
+
+    friend bool operator!=(std::nullptr_t, const basic_copyable_function& f) noexcept
+    {
+        return static_cast<bool>(f);
+    }
+
+    [[nodiscard]] Alloc get_allocator() const noexcept { return this->m_storage.get_allocator(); }
+
+    // Takes over the callable of other if it can be called through the delegate of this
+    // object, otherwise wraps other.
+    template <typename Signature2, size_t Size2, size_t Align2, typename Alloc2>
+    void assign_converted(basic_copyable_function<Signature2, Size2, Align2, Alloc2>& other)
+        noexcept(is_nothrow_storable_v)
+    {
+        if constexpr (base::template is_movable_v<Signature2>)
+        {
+            using other_base = basic_function<Signature2, Size2, Align2, Alloc2>;
+            if (base::adopt(static_cast<other_base&>(other)))
+                return;
+        }
+        base::template assign<true>(std::move(other));
+    }
+
+    // True if the callable is stored inline and copying it cannot throw.
+    [[nodiscard]] bool nothrow_copyable() const noexcept
+    {
+        return !this->m_delegate.allocated() && this->m_delegate.trivially_copyable();
+    }
+};
+
+// basic_copyable_function with the same inline storage size and alignment as function.
+template <typename Signature, typename Alloc = allocator>
+class copyable_function
+    : public basic_copyable_function<
+        Signature,
+        details::function_ns::default_size,
+        details::function_ns::default_alignment,
+        Alloc>
+{
+    using base = basic_copyable_function<
+        Signature,
+        details::function_ns::default_size,
+        details::function_ns::default_alignment,
+        Alloc>;
+
+public:
+    using base::base;
+
+    copyable_function() = default;
+
+    // Forwards to the assignments of basic_copyable_function, but returns this type.
+    template <typename T, DZE_REQUIRES(std::is_assignable_v<base&, T&&>)>
+    copyable_function& operator=(T&& value) noexcept(std::is_nothrow_assignable_v<base&, T&&>)
+    {
+        base::operator=(std::forward<T>(value));
+        return *this;
+    }
+};
+
+template <typename Signature, size_t Size, size_t Align, typename Alloc, typename Callable>
+struct function_fits_inline<basic_copyable_function<Signature, Size, Align, Alloc>, Callable>
+    : function_fits_inline<basic_function<Signature, Size, Align, Alloc>, Callable> {};
+
+template <typename Signature, typename Alloc, typename Callable>
+struct function_fits_inline<copyable_function<Signature, Alloc>, Callable>
+    : function_fits_inline<function<Signature, Alloc>, Callable> {};
+
+template <typename R, typename... Args, typename Alloc = allocator>
+copyable_function(R(*)(Args...), Alloc = Alloc{}) -> copyable_function<R(Args...) const, Alloc>;
+
+template <typename R, typename... Args, typename Alloc = allocator>
+copyable_function(R(*)(Args...) noexcept, Alloc = Alloc{}) ->
+    copyable_function<R(Args...) const noexcept, Alloc>;
+
+template <
+    typename Callable,
+    typename Signature = details::function_ns::guide_helper_t<Callable>,
+    typename Alloc = allocator>
+copyable_function(Callable, Alloc = Alloc{}) -> copyable_function<Signature, Alloc>;
+
+namespace pmr {
+
+template <typename Signature>
+using copyable_function = ::dze::copyable_function<Signature, polymorphic_allocator>;
+
+} // namespace pmr
+
+} // namespace dze
@@ -1,10 +1,13 @@
 #pragma once
 
 #include <cassert>
+#include <cstddef>
 #include <cstring>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 
+#include <dze/trivially_relocatable.hpp>
 #include <dze/type_traits.hpp>
 
 namespace dze::details::function_ns {
@@ -18,88 +21,414 @@ auto& get_object(void* const data) noexcept
     return *static_cast<cast_to*>(data);
 }
 
+// The address of type_tag<T> identifies T without RTTI.
+// It is not const, so it is never merged with the tag of another type.
+template <typename T>
+inline char type_tag = 0;
+
+// Type of the parameters of the type erased call operations for an argument of type T.
+// Small trivially copyable arguments are passed by value, so they stay in registers.
+// Other arguments are passed by reference, so by value arguments are only materialized
+// in the parameters of the call operator of the owner and moved from there once, into
+// the parameters of the callable.
+template <typename T>
+using param_t = std::conditional_t<
+    std::is_trivially_copyable_v<T> && sizeof(T) <= 2 * sizeof(void*), T, T&&>;
+
+// data points to the inline buffer of the owner.
+// An allocated callable is reached through the pointer at the beginning of the buffer,
+// so callers pass the same address whether the callable is allocated or not.
 template <
     typename Callable,
     bool Const,
     bool Noexcept,
+    bool Allocated,
     typename R,
     typename... Args,
     DZE_REQUIRES(std::is_invocable_r_v<R, Callable, Args...>)>
-R call_stub(void* const data, Args... args) noexcept(Noexcept)
+R call_stub(void* data, param_t<Args>... args) noexcept(Noexcept)
 {
+    if constexpr (Allocated)
+        data = *static_cast<void* const*>(data);
+
     if constexpr (std::is_void_v<R>)
         get_object<Callable, Const>(data)(static_cast<Args&&>(args)...);
     else
         return get_object<Callable, Const>(data)(static_cast<Args&&>(args)...);
 }
 
+// Moves the object at from to to and destroys the object at from.
+template <typename Callable>
+void relocate_stub(void* const from, void* const to) noexcept
+{
+    using callable_decay_t = std::decay_t<Callable>;
+
+    ::new (to) callable_decay_t{std::move(get_object<Callable, false>(from))};
+    get_object<Callable, false>(from).~callable_decay_t();
+}
+
+template <typename Callable>
+void destroy_stub(void* const data) noexcept
+{
+    using callable_decay_t = std::decay_t<Callable>;
+
+    get_object<Callable, false>(data).~callable_decay_t();
+}
+
+// Copies the object at from to to.
 template <typename Callable>
-void move_delete_stub(void* const from, void* const to) noexcept
+void copy_stub(const void* const from, void* const to)
 {
     using callable_decay_t = std::decay_t<Callable>;
 
-    if (to != nullptr)
-        ::new (to) callable_decay_t{std::move(get_object<Callable, false>(from))};
+    ::new (to) callable_decay_t{get_object<Callable, true>(const_cast<void*>(from))};
+}
+
+// Operations on a type erased callable. One instance exists for each callable type.
+// Null relocate means the callable is relocated with memcpy.
+// Null destroy means the callable is trivially destructible.
+// So trivially copyable callables of all types share these operations, and only their
+// call stubs are instantiated for each type.
+// Copy is only set for callables stored in copyable functions.
+// For those, null copy means the callable is copied with memcpy.
+// Allocated is true if the callable is stored in dynamically allocated memory.
+// This keeps the owner from spending a padded flag on it.
+// Type is the address of the type_tag of the callable, or null if there is none.
+// The call operation takes the address of the inline buffer, see call_stub.
+// It does not depend on the noexcept specification of the signature
+// so that the table layout is the same for all signatures with the same arguments.
+template <typename R, typename... Args>
+struct vtable_t
+{
+    using call_t = R(void*, param_t<Args>...);
+    using relocate_t = void(void*, void*) noexcept;
+    using destroy_t = void(void*) noexcept;
+    using copy_t = void(const void*, void*);
+
+    call_t* call;
+    relocate_t* relocate;
+    destroy_t* destroy;
+    copy_t* copy;
+    bool allocated;
+    const void* type;
+};
+
+template <typename Callable>
+constexpr auto get_relocate() noexcept
+{
+    using relocate_t = void(void*, void*) noexcept;
+
+    if constexpr (is_trivially_relocatable_v<std::decay_t<Callable>>)
+        return static_cast<relocate_t*>(nullptr);
+    else
+        return &relocate_stub<std::decay_t<Callable>>;
+}
+
+template <typename Callable>
+constexpr auto get_destroy() noexcept
+{
+    using destroy_t = void(void*) noexcept;
+
+    if constexpr (std::is_trivially_destructible_v<std::decay_t<Callable>>)
+        return static_cast<destroy_t*>(nullptr);
+    else
+        return &destroy_stub<std::decay_t<Callable>>;
+}
+
+template <typename Callable, bool Copyable>
+constexpr auto get_copy() noexcept
+{
+    using copy_t = void(const void*, void*);
+
+    if constexpr (!Copyable || std::is_trivially_copyable_v<std::decay_t<Callable>>)
+        return static_cast<copy_t*>(nullptr);
     else
-        get_object<Callable, false>(from).~callable_decay_t();
+        return &copy_stub<std::decay_t<Callable>>;
 }
 
+// Copyable without a copy stub, so that copyable and move-only owners of a trivially
+// copyable callable share its vtable.
+template <typename Callable, bool Copyable>
+inline constexpr bool needs_copy_v =
+    Copyable && !std::is_trivially_copyable_v<std::decay_t<Callable>>;
+
+template <
+    typename Callable,
+    bool Const,
+    bool Noexcept,
+    bool Copyable,
+    bool Allocated,
+    typename R,
+    typename... Args>
+inline constexpr vtable_t<R, Args...> vtable_for = {
+    &call_stub<Callable, Const, Noexcept, Allocated, R, Args...>,
+    get_relocate<Callable>(),
+    get_destroy<Callable>(),
+    get_copy<Callable, Copyable>(),
+    Allocated,
+    &type_tag<std::decay_t<Callable>>};
+
+// vtable of function pointers of exactly the signature, which are stored inline.
+// They are called through the call stub like other callables, but function_ref binds
+// the function pointer itself instead of the stub.
+template <bool Noexcept, typename R, typename... Args>
+inline constexpr vtable_t<R, Args...> fn_vtable = {
+    &call_stub<R(*)(Args...) noexcept(Noexcept), true, Noexcept, false, R, Args...>,
+    nullptr,
+    nullptr,
+    nullptr,
+    false,
+    &type_tag<R(*)(Args...) noexcept(Noexcept)>};
+
+template <typename VTable>
+constexpr VTable make_empty_vtable(const bool allocated) noexcept
+{
+    VTable vtable{};
+    vtable.allocated = allocated;
+    return vtable;
+}
+
+template <typename VTable>
+inline constexpr VTable empty_vtable = make_empty_vtable<VTable>(false);
+
+// Empty state of an owner that keeps an allocation for reuse.
+template <typename VTable>
+inline constexpr VTable empty_allocated_vtable = make_empty_vtable<VTable>(true);
+
+// Operations that do not depend on the signatures of the vtable.
+template <typename VTable>
+class delegate_base
+{
+public:
+    void reset() noexcept { m_vtable = &empty_vtable<VTable>; }
+
+    void reset_allocated() noexcept { m_vtable = &empty_allocated_vtable<VTable>; }
+
+    // Resets to the empty state that matches allocated().
+    void clear() noexcept
+    {
+        if (allocated())
+            reset_allocated();
+        else
+            reset();
+    }
+
+    // Moves the object at from to to, and destroys the object at from.
+    // size is the number of bytes copied when the object is trivially movable.
+    void relocate(void* const from, void* const to, const size_t size) const noexcept
+    {
+        if (m_vtable->relocate != nullptr)
+            m_vtable->relocate(from, to);
+        else
+            std::memcpy(to, from, size);
+    }
+
+    void destroy(void* const data) const noexcept
+    {
+        if (m_vtable->destroy != nullptr)
+            m_vtable->destroy(data);
+    }
+
+    // Copies the object at from to to.
+    // size is the number of bytes copied when the object is trivially copyable.
+    // Pre-condition: An object is stored at from and it was set as copyable.
+    void copy(const void* const from, void* const to, const size_t size) const
+    {
+        assert(!empty());
+        if (m_vtable->copy != nullptr)
+            m_vtable->copy(from, to);
+        else
+            std::memcpy(to, from, size);
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return m_vtable == &empty_vtable<VTable> ||
+            m_vtable == &empty_allocated_vtable<VTable>;
+    }
+
+    // True if the owner holds an allocation, whether a callable is stored or not.
+    [[nodiscard]] bool allocated() const noexcept { return m_vtable->allocated; }
+
+    // True if the stored object, if any, can be relocated by copying its bytes.
+    [[nodiscard]] bool trivially_movable() const noexcept
+    {
+        return m_vtable->relocate == nullptr;
+    }
+
+    // Address of the vtable, which is the same for delegates that call the same stub.
+    [[nodiscard]] const void* vtable() const noexcept { return m_vtable; }
+
+    // True if the stored object is a T.
+    template <typename T>
+    [[nodiscard]] bool holds() const noexcept { return m_vtable->type == &type_tag<T>; }
+
+    // True if the stored object, if any, can be copied by copying its bytes.
+    // Pre-condition: The object was set as copyable.
+    [[nodiscard]] bool trivially_copyable() const noexcept { return m_vtable->copy == nullptr; }
+
+protected:
+    const VTable* m_vtable;
+};
+
 template <typename, bool>
 class delegate_t;
 
+// Nothing in the declaration of this class depends on param_t, which needs complete
+// argument types, so functions can be members of classes that their arguments are only
+// declared in. vtable_t is only instantiated by the bodies of the member functions.
 template <bool Noexcept, typename R, typename... Args>
-class delegate_t<R(Args...), Noexcept>
+class delegate_t<R(Args...), Noexcept> : public delegate_base<vtable_t<R, Args...>>
 {
 public:
+    using fn_t = R(Args...) noexcept(Noexcept);
+
     delegate_t() = default;
 
-    template <typename Callable, bool Const>
+    // The vtables of noexcept signatures are also valid without noexcept.
+    template <bool Noexcept2, DZE_REQUIRES(Noexcept2 && !Noexcept)>
+    delegate_t(const delegate_t<R(Args...), Noexcept2>& other) noexcept
+    {
+        this->m_vtable = other.m_vtable;
+    }
+
+    // Function pointers in allocated memory are called through the call stub.
+    template <typename Callable, bool Const, bool Copyable, bool Allocated>
     void set() noexcept
     {
-        m_call = call_stub<Callable, Const, Noexcept, R, Args...>;
-        m_move_delete = move_delete_stub<Callable>;
+        if constexpr (std::is_same_v<Callable, fn_t*> && !Allocated)
+            this->m_vtable = &fn_vtable<Noexcept, R, Args...>;
+        else
+        {
+            this->m_vtable =
+                &vtable_for<
+                    Callable, Const, Noexcept, needs_copy_v<Callable, Copyable>, Allocated, R,
+                    Args...>;
+        }
     }
 
-    void reset() noexcept
+    // True if the stored object is a function pointer of exactly the signature.
+    [[nodiscard]] bool direct() const noexcept
     {
-        m_call = nullptr;
-        m_move_delete = nullptr;
+        return this->m_vtable == &fn_vtable<Noexcept, R, Args...>;
     }
 
-    void move(void* const from, void* const to) const noexcept
+    // Pre-condition: !direct()
+    [[nodiscard]] auto* get_call() const noexcept { return this->m_vtable->call; }
+
+    // Params are the parameters of the call operation, see param_t.
+    template <typename... Params>
+    R call(const void* const data, Params&&... params) const noexcept(Noexcept)
     {
-        if (m_move_delete != nullptr)
-            m_move_delete(from, to);
+        return call(const_cast<void*>(data), std::forward<Params>(params)...);
     }
 
-    void destroy(void* const data) const noexcept
+    template <typename... Params>
+    R call(void* data, Params&&... params) const noexcept(Noexcept)
     {
-        if (m_move_delete != nullptr)
-            m_move_delete(data, nullptr);
+        assert(!this->empty());
+        return this->m_vtable->call(data, std::forward<Params>(params)...);
     }
 
-    [[nodiscard]] bool empty() const noexcept { return m_call == nullptr; }
+private:
+    template <typename, bool>
+    friend class delegate_t;
+};
+
+template <typename>
+struct signature_traits;
 
-    R call(const void* const data, Args... args) const noexcept(Noexcept)
-    {
-        assert(!empty());
+template <bool Noexcept, typename R, typename... Args>
+struct signature_traits<R(Args...) noexcept(Noexcept)>
+{
+    using call_t = typename vtable_t<R, Args...>::call_t;
+
+    template <typename Callable, bool Allocated>
+    static constexpr call_t* stub =
+        &call_stub<Callable, false, Noexcept, Allocated, R, Args...>;
+};
 
-        return m_call(const_cast<void*>(data), static_cast<Args&&>(args)...);
+template <bool Noexcept, typename R, typename... Args>
+struct signature_traits<R(Args...) const noexcept(Noexcept)>
+{
+    using call_t = typename vtable_t<R, Args...>::call_t;
+
+    template <typename Callable, bool Allocated>
+    static constexpr call_t* stub =
+        &call_stub<Callable, true, Noexcept, Allocated, R, Args...>;
+};
+
+// vtable_t with one call operation for each of Signatures.
+template <typename... Signatures>
+struct multi_vtable_t
+{
+    using relocate_t = void(void*, void*) noexcept;
+    using destroy_t = void(void*) noexcept;
+    using copy_t = void(const void*, void*);
+
+    std::tuple<typename signature_traits<Signatures>::call_t*...> calls;
+    relocate_t* relocate;
+    destroy_t* destroy;
+    copy_t* copy;
+    bool allocated;
+    const void* type;
+};
+
+template <typename Callable, bool Copyable, bool Allocated, typename... Signatures>
+inline constexpr multi_vtable_t<Signatures...> multi_vtable_for = {
+    {signature_traits<Signatures>::template stub<Callable, Allocated>...},
+    get_relocate<Callable>(),
+    get_destroy<Callable>(),
+    get_copy<Callable, Copyable>(),
+    Allocated,
+    &type_tag<std::decay_t<Callable>>};
+
+// Delegate of a callable that is called with any of Signatures.
+template <typename... Signatures>
+class multi_delegate_t : public delegate_base<multi_vtable_t<Signatures...>>
+{
+public:
+    multi_delegate_t() = default;
+
+    // Const is ignored, each call operation is const if its signature is.
+    template <typename Callable, bool Const, bool Copyable, bool Allocated>
+    void set() noexcept
+    {
+        this->m_vtable = &multi_vtable_for<
+            Callable, needs_copy_v<Callable, Copyable>, Allocated, Signatures...>;
     }
 
-    R call(void* data, Args... args) const noexcept(Noexcept)
+    // Calls the call operation of the signature at index I.
+    template <size_t I, typename... Params>
+    decltype(auto) call(const void* const data, Params&&... params) const
     {
-        assert(!empty());
+        assert(!this->empty());
 
-        return m_call(data, static_cast<Args&&>(args)...);
+        return std::get<I>(this->m_vtable->calls)(
+            const_cast<void*>(data), std::forward<Params>(params)...);
     }
+};
 
-private:
-    using call_t = R(void*, Args...) noexcept(Noexcept);
-    using move_delete_t = void(void*, void*) noexcept;
+// True if a callable stored by the delegate of signature From can be called through the
+// delegate of signature To, that is if To is From, or From without const or noexcept.
+template <typename From, typename To>
+struct is_adoptable_signature : std::is_same<From, To> {};
 
-    call_t* m_call;
-    move_delete_t* m_move_delete;
-};
+template <bool Noexcept1, bool Noexcept2, typename R, typename... Args>
+struct is_adoptable_signature<R(Args...) noexcept(Noexcept1), R(Args...) noexcept(Noexcept2)>
+    : std::bool_constant<Noexcept1 || !Noexcept2> {};
+
+template <bool Noexcept1, bool Noexcept2, typename R, typename... Args>
+struct is_adoptable_signature<
+    R(Args...) const noexcept(Noexcept1), R(Args...) noexcept(Noexcept2)>
+    : std::bool_constant<Noexcept1 || !Noexcept2> {};
+
+template <bool Noexcept1, bool Noexcept2, typename R, typename... Args>
+struct is_adoptable_signature<
+    R(Args...) const noexcept(Noexcept1), R(Args...) const noexcept(Noexcept2)>
+    : std::bool_constant<Noexcept1 || !Noexcept2> {};
+
+template <typename From, typename To>
+inline constexpr bool is_adoptable_signature_v = is_adoptable_signature<From, To>::value;
 
 } // namespace dze::details::function_ns
@@ -1,27 +1,71 @@
 #pragma once
 
 #include <algorithm>
-#include <cassert>
-#include <climits>
 #include <cstddef>
 #include <cstring>
-#include <limits>
 #include <memory>
 #include <utility>
 
+// Marks the paths that allocate, which only callables too big for the inline buffer take.
+// Keeping them out of line keeps the inline paths of the owners small, and the compiler
+// lays out the branches to them as unlikely.
+#if defined(__GNUC__)
+#define DZE_FUNCTION_COLD __attribute__((cold, noinline))
+#elif defined(_MSC_VER)
+#define DZE_FUNCTION_COLD __declspec(noinline)
+#else
+#define DZE_FUNCTION_COLD
+#endif
+
 namespace dze::details::function_ns {
 
-// This class is only available on little endian systems.
-// Size must be greater than or equal to sizeof(alloc_details).
+// Hints that data at p is about to be read. p does not need to point to an object.
+inline void prefetch(const void* const p) noexcept
+{
+#if defined(__GNUC__)
+    __builtin_prefetch(p);
+#else
+    static_cast<void>(p);
+#endif
+}
+
+// Not std::hardware_destructive_interference_size, whose value may change between
+// compiler versions and must not be part of the layout of types in headers.
+inline constexpr size_t cache_line_size = 64;
+
+// The pointer to the allocation must be at the beginning of the inline buffer for the
+// call stubs of allocated callables, see call_stub.
+struct alloc_details
+{
+    void* data;
+    size_t size;
+    size_t alignment;
+};
+
+static_assert(offsetof(alloc_details, data) == 0);
+
+template <size_t Size>
+struct inline_buffer
+{
+    alignas(alloc_details) std::byte data[Size];
+};
+
+// The inline buffer is at least as big and as aligned as the dynamic allocation
+// book keeping bits, even if Size and Align are smaller.
+// The inline buffer is at the beginning of this object and it is aligned to
+// max_inline_alignment() only if this object is. This lets the owner place its own
+// members right after the buffer instead of after the alignment padding.
+// This class does not know whether it holds an allocation. The owner keeps track of it
+// and calls the functions that access the allocation only when there is one.
 template <size_t Size, size_t Align, typename Alloc>
-class storage : private Alloc
+class storage
+    : private inline_buffer<std::max(Size, sizeof(alloc_details))>
+    , private Alloc
 {
-    struct alloc_details
-    {
-        void* data;
-        size_t size;
-        size_t alignment;
-    };
+    static constexpr size_t inline_size = std::max(Size, sizeof(alloc_details));
+    static constexpr size_t inline_alignment = std::max(Align, alignof(alloc_details));
+
+    using buffer_type = inline_buffer<inline_size>;
 
 public:
     using allocator_type = Alloc;
@@ -30,156 +74,138 @@ public:
     using pointer = void*;
 
     explicit storage(const Alloc& alloc) noexcept
-        : Alloc{alloc} {}
-
-    storage(
-        const size_type size, // NOLINT(readability-avoid-const-params-in-decls)
-        size_type alignment,
-        const Alloc& alloc = Alloc{}) noexcept(noexcept(this->allocate(size, alignment)))
-        : Alloc{alloc}
-    {
-        if (size > Size || alignment > Align)
-        {
-            alignment = std::max(Align, alignment);
-            const auto buf = allocate(size, alignment);
-            init_alloc_details(buf, size, alignment);
-        }
-    }
+        : buffer_type{}
+        , Alloc{alloc} {}
 
+    // Only moves the allocator.
     storage(storage&& other) noexcept
-        : Alloc{std::move(other.get_allocator())}
-        , m_storage{} {}
-
-    ~storage() { deallocate(); }
+        : buffer_type{}
+        , Alloc{std::move(other.allocator())} {}
 
     void move_allocator(storage& other)
     {
-        get_allocator() = std::move(other.get_allocator());
+        allocator() = std::move(other.allocator());
     }
 
-    void move_allocated(storage& other)
+    // Takes over the allocation of other.
+    // Pre-condition: other has an allocation from an allocator equal to the allocator of
+    // this object, and this object does not have an allocation.
+    template <size_t Size2, size_t Align2>
+    void move_allocated(storage<Size2, Align2, Alloc>& other) noexcept
     {
         ::new (&as_alloc_details()) alloc_details{other.as_alloc_details()};
-        m_storage.allocated = true;
-        other.as_alloc_details().~alloc_details();
-        other.m_storage.allocated = false;
     }
 
-    void swap_allocator(storage& other) noexcept
+    // Takes over the inline buffer of other, including its allocation if there is one,
+    // by copying its bytes.
+    // Pre-condition: This object does not have an allocation.
+    void relocate(storage& other) noexcept
     {
-        swap(get_allocator(), other.get_allocator());
+        std::memcpy(&buffer(), &other.buffer(), sizeof(buffer_type));
     }
 
-    void swap_allocated(storage& other)
+    // Swaps the inline buffers, including the allocations, by swapping their bytes.
+    // Allocators are not swapped.
+    void swap_inline(storage& other) noexcept
     {
-        std::swap(as_alloc_details(), other.as_alloc_details());
+        std::swap(buffer(), other.buffer());
     }
 
-    // Discards the stored data if new_size results in allocation.
-    void resize(const size_type size, size_t alignment)
-        noexcept(noexcept(this->allocate(size, alignment)))
+    // Pre-condition: This object does not have an allocation.
+    DZE_FUNCTION_COLD void allocate(const size_type size, size_t alignment)
+        noexcept(noexcept(std::declval<Alloc&>().allocate_bytes(size, alignment)))
     {
-        if (allocated())
-        {
-            if (size > allocated_size() || alignment > allocated_alignment())
-            {
-                alignment = std::max(Align, alignment);
-                const auto buf = allocate(size, alignment);
-                unchecked_deallocate();
-                as_alloc_details() = {buf, size, alignment};
-            }
-        }
-        else
-        {
-            if (size > Size || alignment > Align)
-            {
-                alignment = std::max(Align, alignment);
-                const auto buf = allocate(size, alignment);
-                init_alloc_details(buf, size, alignment);
-            }
-        }
+        alignment = std::max(inline_alignment, alignment);
+        const auto buf = allocator().allocate_bytes(size, alignment);
+        ::new (&as_alloc_details()) alloc_details{buf, size, alignment};
     }
 
-    void deallocate() noexcept
+    // Keeps the allocation if it is big enough and aligned enough.
+    // Otherwise replaces it and discards the stored data.
+    // Pre-condition: This object has an allocation.
+    void reallocate(const size_type size, const size_t alignment)
+        noexcept(noexcept(std::declval<Alloc&>().allocate_bytes(size, alignment)))
     {
-        if (allocated())
-            unchecked_deallocate();
+        if (size > allocated_size() || alignment > allocated_alignment())
+            replace_allocation(size, alignment);
     }
 
-    [[nodiscard]] allocator_type get_allocator() const noexcept { return *this; }
-
-    [[nodiscard]] bool allocated() const noexcept
+    // Pre-condition: This object has an allocation.
+    DZE_FUNCTION_COLD void deallocate() noexcept
     {
-        return m_storage.allocated;
+        allocator().deallocate_bytes(
+            allocated_data(), allocated_size(), allocated_alignment());
     }
 
-    [[nodiscard]] const_pointer data() const noexcept
+    [[nodiscard]] allocator_type get_allocator() const noexcept { return *this; }
+
+    [[nodiscard]] const_pointer inline_data() const noexcept { return buffer().data; }
+
+    [[nodiscard]] pointer inline_data() noexcept { return buffer().data; }
+
+    [[nodiscard]] const_pointer allocated_data() const noexcept
     {
-        return allocated() ? allocated_data() : m_storage.data;
+        return as_alloc_details().data;
     }
 
-    [[nodiscard]] pointer data() noexcept
-    { 
-        return allocated() ? allocated_data() : m_storage.data; 
-    }
+    [[nodiscard]] pointer allocated_data() noexcept { return as_alloc_details().data; }
 
     [[nodiscard]] size_type allocated_size() const noexcept
     {
         return as_alloc_details().size;
     }
 
-    [[nodiscard]] static constexpr size_t max_inline_size() noexcept
-    {
-        return Size;
-    }
-
     [[nodiscard]] size_type allocated_alignment() const noexcept
     {
         return as_alloc_details().alignment;
     }
 
-private:
-    static_assert(
-        Size >= sizeof(alloc_details),
-        "Inline storage size of this object must be bigger than or equal to "
-        "size of the dynamic allocation book keeping bits.");
-
-    struct alignas(Align)
+    [[nodiscard]] static constexpr size_t max_inline_size() noexcept
     {
-        std::byte data[Size];
-        bool allocated = false;
-    } m_storage;
+        return inline_size;
+    }
 
-    [[nodiscard]] const alloc_details& as_alloc_details() const noexcept
+    [[nodiscard]] static constexpr size_t max_inline_alignment() noexcept
     {
-        return *reinterpret_cast<const alloc_details*>(&m_storage.data);
+        return inline_alignment;
     }
 
-    [[nodiscard]] alloc_details& as_alloc_details() noexcept
+    [[nodiscard]] static constexpr bool fits_inline(
+        const size_t size, const size_t alignment) noexcept
     {
-        return *reinterpret_cast<alloc_details*>(&m_storage.data);
+        return size <= inline_size && alignment <= inline_alignment;
     }
 
-    [[nodiscard]] const_pointer allocated_data() const noexcept { return as_alloc_details().data; }
+private:
+    template <size_t, size_t, typename>
+    friend class storage;
+
+    static_assert(
+        Align != 0 && (Align & (Align - 1)) == 0, "Alignment must be a power of two.");
 
-    [[nodiscard]] pointer allocated_data() noexcept { return as_alloc_details().data; }
+    [[nodiscard]] Alloc& allocator() noexcept { return *this; }
 
-    void init_alloc_details(const pointer data, const size_t size, const size_t alignment) noexcept
+    DZE_FUNCTION_COLD void replace_allocation(const size_type size, size_t alignment)
+        noexcept(noexcept(std::declval<Alloc&>().allocate_bytes(size, alignment)))
     {
-        ::new (&as_alloc_details()) alloc_details{data, size, alignment};
-        m_storage.allocated = true;
+        alignment = std::max(inline_alignment, alignment);
+        const auto buf = allocator().allocate_bytes(size, alignment);
+        deallocate();
+        as_alloc_details() = {buf, size, alignment};
     }
 
-    [[nodiscard]] auto allocate(const size_t size, const size_t alignment)
-        noexcept(noexcept(get_allocator().allocate_bytes(size, alignment)))
+    [[nodiscard]] const buffer_type& buffer() const noexcept { return *this; }
+
+    [[nodiscard]] buffer_type& buffer() noexcept { return *this; }
+
+    [[nodiscard]] const alloc_details& as_alloc_details() const noexcept
     {
-        return get_allocator().allocate_bytes(size, alignment);
+        return *reinterpret_cast<const alloc_details*>(&buffer().data);
     }
 
-    void unchecked_deallocate() noexcept
+    [[nodiscard]] alloc_details& as_alloc_details() noexcept
     {
-        get_allocator().deallocate_bytes(
-            allocated_data(), allocated_size(), allocated_alignment());
+        return *reinterpret_cast<alloc_details*>(&buffer().data);
     }
 };
 
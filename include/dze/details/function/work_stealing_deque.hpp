@@ -0,0 +1,148 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include <dze/function_queue.hpp>
+
+namespace dze::details::function_ns {
+
+// Bounded Chase-Lev deque. The owner pushes and pops at the bottom, thieves steal from
+// the top.
+// Unlike the original algorithm, a thief claims an element before reading it, so elements
+// do not have to be trivially copyable. Each slot has a sequence number, as in
+// function_queue, which tells the owner whether the thief that took the previous element
+// of the slot is done with it.
+template <typename T>
+class work_stealing_deque
+{
+    static_assert(std::is_nothrow_move_constructible_v<T>);
+
+    struct slot_type
+    {
+        // Position for which the slot can be written.
+        std::atomic<std::int64_t> sequence;
+        alignas(T) std::byte storage[sizeof(T)];
+
+        [[nodiscard]] T& get() noexcept
+        {
+            return *std::launder(reinterpret_cast<T*>(storage));
+        }
+    };
+
+public:
+    // The capacity is rounded up to a power of two.
+    explicit work_stealing_deque(const size_t capacity)
+        : m_mask{static_cast<std::int64_t>(round_up_to_power_of_two(capacity)) - 1}
+        , m_slots{new slot_type[this->capacity()]}
+    {
+        for (size_t i = 0; i != this->capacity(); ++i)
+            m_slots[i].sequence.store(static_cast<std::int64_t>(i), std::memory_order_relaxed);
+    }
+
+    work_stealing_deque(const work_stealing_deque&) = delete;
+    work_stealing_deque& operator=(const work_stealing_deque&) = delete;
+
+    // Pre-condition: No other thread uses this object.
+    ~work_stealing_deque()
+    {
+        while (pop()) {}
+    }
+
+    // Owner only.
+    // Returns false and leaves value alone if the deque is full.
+    [[nodiscard]] bool push(T&& value) noexcept
+    {
+        const auto b = m_bottom.load(std::memory_order_relaxed);
+        const auto t = m_top.load(std::memory_order_acquire);
+        if (b - t > m_mask)
+            return false;
+
+        auto& slot = m_slots[b & m_mask];
+        if (slot.sequence.load(std::memory_order_acquire) != b)
+            return false;
+
+        ::new (slot.storage) T{std::move(value)};
+        m_bottom.store(b + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Owner only.
+    [[nodiscard]] std::optional<T> pop() noexcept
+    {
+        const auto b = m_bottom.load(std::memory_order_relaxed) - 1;
+        m_bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto t = m_top.load(std::memory_order_relaxed);
+
+        if (t > b)
+        {
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+
+        if (t < b)
+            return take(b, b);
+
+        // Last element, race against thieves.
+        const bool won = m_top.compare_exchange_strong(
+            t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        m_bottom.store(b + 1, std::memory_order_relaxed);
+        if (!won)
+            return std::nullopt;
+
+        return take(b, b + m_mask + 1);
+    }
+
+    // Any thread.
+    [[nodiscard]] std::optional<T> steal() noexcept
+    {
+        auto t = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const auto b = m_bottom.load(std::memory_order_acquire);
+        if (t >= b)
+            return std::nullopt;
+
+        if (!m_top.compare_exchange_strong(
+                t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            return std::nullopt;
+        }
+
+        return take(t, t + m_mask + 1);
+    }
+
+    // Only a snapshot when other threads use this object.
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return m_bottom.load(std::memory_order_relaxed) <=
+            m_top.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] size_t capacity() const noexcept { return static_cast<size_t>(m_mask) + 1; }
+
+private:
+    const std::int64_t m_mask;
+    const std::unique_ptr<slot_type[]> m_slots;
+    alignas(cache_line_size) std::atomic<std::int64_t> m_top{0};
+    alignas(cache_line_size) std::atomic<std::int64_t> m_bottom{0};
+
+    // Moves the element at pos out and marks its slot as writable for next_pos.
+    [[nodiscard]] std::optional<T> take(const std::int64_t pos, const std::int64_t next_pos)
+        noexcept
+    {
+        auto& slot = m_slots[pos & m_mask];
+        std::optional<T> result{std::move(slot.get())};
+        slot.get().~T();
+        slot.sequence.store(next_pos, std::memory_order_release);
+        return result;
+    }
+};
+
+} // namespace dze::details::function_ns
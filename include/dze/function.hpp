@@ -1,12 +1,16 @@
 #pragma once
 
+#include <algorithm>
+#include <cassert>
 #include <cstddef>
 #include <functional>
+#include <memory>
 #include <type_traits>
 #include <utility>
 
 #include <dze/allocator.hpp>
 #include <dze/memory_resource.hpp>
+#include <dze/trivially_relocatable.hpp>
 #include <dze/type_traits.hpp>
 
 #include "details/function/delegate.hpp"
@@ -20,6 +24,30 @@ template <typename From, typename To>
 inline constexpr bool is_safely_convertible_v =
     !std::is_reference_v<To> || std::is_reference_v<From>;
 
+template <bool, bool, typename, typename...>
+class ref_base;
+
+struct batch_access;
+
+// True if an lvalue of type T, const for const signatures, can be called like Signature.
+template <typename T, typename Signature, typename = void>
+struct is_invocable_as : std::false_type {};
+
+template <typename T, bool Noexcept, typename R, typename... Args>
+struct is_invocable_as<
+    T,
+    R(Args...) noexcept(Noexcept),
+    std::enable_if_t<
+        (Noexcept
+            ? std::is_nothrow_invocable_v<T&, Args...>
+            : std::is_invocable_v<T&, Args...>) &&
+        is_safely_convertible_v<std::invoke_result_t<T&, Args...>, R>>>
+    : std::true_type {};
+
+template <typename T, bool Noexcept, typename R, typename... Args>
+struct is_invocable_as<T, R(Args...) const noexcept(Noexcept)>
+    : is_invocable_as<const T, R(Args...) noexcept(Noexcept)> {};
+
 template <typename, typename>
 class base;
 
@@ -31,24 +59,9 @@ public:
     R operator()(Args... args) noexcept(Noexcept)
     {
         auto& obj = *static_cast<Function*>(this);
-        return obj.m_delegate.call(obj.data_addr(), static_cast<Args&&>(args)...);
+        return obj.m_delegate.call(obj.call_addr(), static_cast<Args&&>(args)...);
     }
 
-private:
-    template <typename Callable, typename = void>
-    struct is_convertible : std::false_type {};
-
-    template <typename Callable>
-    struct is_convertible<
-        Callable,
-        std::enable_if_t<
-            (Noexcept
-                ? std::is_nothrow_invocable_v<std::decay_t<Callable>&, Args...>
-                : std::is_invocable_v<std::decay_t<Callable>&, Args...>) &&
-            is_safely_convertible_v<
-                std::invoke_result_t<std::decay_t<Callable>&, Args...>, R>>>
-        : std::true_type {};
-
 protected:
     using delegate_type = delegate_t<R(Args...), Noexcept>;
     using const_signature = R(Args...) const noexcept(Noexcept);
@@ -57,7 +70,8 @@ protected:
     static constexpr bool is_const = false;
 
     template <typename Callable>
-    static constexpr bool is_convertible_v = is_convertible<Callable>::value;
+    static constexpr bool is_convertible_v =
+        is_invocable_as<std::decay_t<Callable>, mut_signature>::value;
 };
 
 template <typename Function, bool Noexcept, typename R, typename... Args>
@@ -68,24 +82,9 @@ public:
     R operator()(Args... args) const noexcept(Noexcept)
     {
         auto& obj = *static_cast<const Function*>(this);
-        return obj.m_delegate.call(obj.data_addr(), static_cast<Args&&>(args)...);
+        return obj.m_delegate.call(obj.call_addr(), static_cast<Args&&>(args)...);
     }
 
-private:
-    template <typename Callable, typename = void>
-    struct is_convertible : std::false_type {};
-
-    template <typename Callable>
-    struct is_convertible<
-        Callable,
-        std::enable_if_t<
-            (Noexcept
-                ? std::is_nothrow_invocable_v<const std::decay_t<Callable>&, Args...>
-                : std::is_invocable_v<const std::decay_t<Callable>&, Args...>) &&
-            is_safely_convertible_v<
-                std::invoke_result_t<const std::decay_t<Callable>&, Args...>, R>>>
-        : std::true_type {};
-
 protected:
     using delegate_type = delegate_t<R(Args...), Noexcept>;
     using const_signature = R(Args...) const noexcept(Noexcept);
@@ -94,215 +93,427 @@ protected:
     static constexpr bool is_const = true;
 
     template <typename Callable>
-    static constexpr bool is_convertible_v = is_convertible<Callable>::value;
+    static constexpr bool is_convertible_v =
+        is_invocable_as<std::decay_t<Callable>, const_signature>::value;
+};
+
+// Call operator of Function for the signature at index Index of its overloads.
+template <typename Function, size_t Index, typename Signature>
+class overload;
+
+template <typename Function, size_t Index, bool Noexcept, typename R, typename... Args>
+class overload<Function, Index, R(Args...) noexcept(Noexcept)>
+{
+public:
+    // Pre-condition: A call is stored in this object.
+    R operator()(Args... args) noexcept(Noexcept)
+    {
+        auto& obj = *static_cast<Function*>(this);
+        return obj.m_delegate.template call<Index>(
+            obj.call_addr(), static_cast<Args&&>(args)...);
+    }
+};
+
+template <typename Function, size_t Index, bool Noexcept, typename R, typename... Args>
+class overload<Function, Index, R(Args...) const noexcept(Noexcept)>
+{
+public:
+    // Pre-condition: A call is stored in this object.
+    R operator()(Args... args) const noexcept(Noexcept)
+    {
+        auto& obj = *static_cast<const Function*>(this);
+        return obj.m_delegate.template call<Index>(
+            obj.call_addr(), static_cast<Args&&>(args)...);
+    }
+};
+
+template <typename Function, typename Indices, typename... Signatures>
+class overload_set;
+
+template <typename Function, size_t... Indices, typename... Signatures>
+class overload_set<Function, std::index_sequence<Indices...>, Signatures...>
+    : public overload<Function, Indices, Signatures>...
+{
+public:
+    using overload<Function, Indices, Signatures>::operator()...;
+};
+
+} // namespace details::function_ns
+
+// Signature of a function that stores one callable and calls it with any of Signatures,
+// through one call operator per signature.
+// The calls of all signatures are in the same vtable, so the function is the same size as
+// with a single signature and each call is a single indirect call.
+template <typename... Signatures>
+struct overloads {};
+
+namespace details::function_ns {
+
+template <typename Function, typename... Signatures>
+class base<Function, overloads<Signatures...>>
+    : public overload_set<Function, std::index_sequence_for<Signatures...>, Signatures...>
+{
+    static_assert(sizeof...(Signatures) != 0);
+
+protected:
+    using delegate_type = multi_delegate_t<Signatures...>;
+    using const_signature = overloads<Signatures...>;
+    using mut_signature = overloads<Signatures...>;
+
+    // Unused, the constness of each call comes from its signature.
+    static constexpr bool is_const = false;
+
+    template <typename Callable>
+    static constexpr bool is_convertible_v =
+        (is_invocable_as<std::decay_t<Callable>, Signatures>::value && ...);
 };
 
+// Inline storage size that keeps function at 80 bytes on 64 bit systems.
+// Whether the callable is allocated is recorded in its vtable, so the delegate is the only
+// other member.
+inline constexpr size_t default_size = 80 - sizeof(delegate_t<void(), false>);
+
+inline constexpr size_t default_alignment = alignof(std::max_align_t);
+
+// Inline storage size that makes a function Bytes bytes, with an allocator without state.
+template <size_t Bytes>
+inline constexpr size_t preset_size = Bytes - sizeof(delegate_t<void(), false>);
+
 } // namespace details::function_ns
 
+template <typename, size_t, size_t, typename>
+class basic_function;
+
 template <typename, typename>
 class function;
 
+template <typename, size_t, size_t, typename>
+class basic_copyable_function;
+
 template <typename>
 struct is_function : std::false_type {};
 
+template <typename Signature, size_t Size, size_t Align, typename Alloc>
+struct is_function<basic_function<Signature, Size, Align, Alloc>> : std::true_type {};
+
 template <typename Signature, typename Alloc>
 struct is_function<function<Signature, Alloc>> : std::true_type {};
 
 template <typename T>
 inline constexpr bool is_function_v = is_function<T>::value;
 
+// True if Function stores callables of type Callable in its own buffer, so that storing one
+// never allocates. Function is a function, copyable_function or inplace_function type.
+template <typename Function, typename Callable>
+struct function_fits_inline;
+
+template <typename Function, typename Callable>
+inline constexpr bool function_fits_inline_v =
+    function_fits_inline<Function, Callable>::value;
+
+// Tag to store a callable in memory from the allocator of a function even if it fits
+// inline, so that moving the function only moves the pointer to the callable.
+struct allocated_t
+{
+    explicit allocated_t() = default;
+};
+
+inline constexpr allocated_t allocated{};
+
+// Calls f with args, but calls the callable of f directly if it is a T.
+// At call sites that usually see a T, the compiler can then inline the call, and the
+// indirect call is only made for other types.
+// The callable is called as const if f can be called as const with args.
+// Function is a function, copyable_function or inplace_function type.
+template <typename T, typename Function, typename... Args>
+decltype(auto) call_if(Function& f, Args&&... args)
+{
+    using result_type = decltype(f(std::forward<Args>(args)...));
+    using target_type = std::conditional_t<
+        std::is_invocable_v<const Function&, Args...>, const T, T>;
+
+    // Otherwise f is called as usual.
+    if constexpr (std::is_invocable_v<target_type&, Args...>)
+    {
+        if (target_type* const target = f.template target<T>())
+        {
+            return static_cast<result_type>(
+                std::invoke(*target, std::forward<Args>(args)...));
+        }
+    }
+
+    return f(std::forward<Args>(args)...);
+}
+
 // Move-only polymorphic function wrapper.
-template <typename Signature, typename Alloc = allocator>
-class function : public details::function_ns::base<function<Signature, Alloc>, Signature>
+// Callables that are at most Size bytes and aligned to at most Align are stored inline,
+// unless moving them may throw.
+// Other callables are stored in memory allocated by Alloc, as are callables that are
+// passed with allocated_t.
+// Moving a function only moves its callable if it is stored inline, or if the allocators
+// do not compare equal. A move that throws then terminates.
+// Signature is either a function type or overloads of function types.
+template <typename Signature, size_t Size, size_t Align, typename Alloc = allocator>
+class alignas(details::function_ns::storage<Size, Align, Alloc>::max_inline_alignment())
+    basic_function
+    : public details::function_ns::base<basic_function<Signature, Size, Align, Alloc>, Signature>
 {
-    using base = details::function_ns::base<function, Signature>;
+    using base = details::function_ns::base<basic_function, Signature>;
 
     struct conv_tag_t {};
 
+    // True if the callables of functions of signature Sig can be called through the
+    // delegate of this object, so they can be taken over without being wrapped.
     template <typename Sig>
     static constexpr bool is_movable_v =
-        std::is_same_v<Sig, Signature> ||
-        std::is_same_v<Sig, typename base::const_signature>;
+        details::function_ns::is_adoptable_signature_v<Sig, Signature>;
+
+    template <typename T, typename... Args>
+    static constexpr bool is_emplaceable_v =
+        std::is_same_v<T, std::decay_t<T>> && !is_function_v<T> &&
+        std::is_move_constructible_v<T> && std::is_constructible_v<T, Args...> &&
+        base::template is_convertible_v<T>;
 
 public:
     using allocator_type = Alloc;
 
-    function() noexcept
-        : function{Alloc{}} {}
+    basic_function() noexcept
+        : basic_function{Alloc{}} {}
 
-    function(const Alloc& alloc) noexcept
+    basic_function(const Alloc& alloc) noexcept
         : m_storage{alloc}
     {
         m_delegate.reset();
     }
 
-    function(std::nullptr_t, const Alloc& alloc = Alloc{}) noexcept
-        : function{alloc} {}
+    basic_function(std::nullptr_t, const Alloc& alloc = Alloc{}) noexcept
+        : basic_function{alloc} {}
 
     template <typename Callable,
         DZE_REQUIRES(!is_function_v<Callable> && base::template is_convertible_v<Callable>)>
-    function(Callable call, const Alloc& alloc = Alloc{})
-        noexcept(std::is_nothrow_constructible_v<
-            decltype(this->m_storage), size_t, size_t, const Alloc&>)
-        : function{std::move(call), alloc, conv_tag_t{}} {}
+    basic_function(Callable call, const Alloc& alloc = Alloc{})
+        noexcept(is_nothrow_allocatable_v)
+        : basic_function{std::move(call), alloc, conv_tag_t{}} {}
+
+    // Constructs a T from args directly in its final storage.
+    template <typename T, typename... Args,
+        DZE_REQUIRES(is_emplaceable_v<T, Args...>)>
+    explicit basic_function(std::in_place_type_t<T>, Args&&... args)
+        noexcept(is_nothrow_emplaceable_v<T, Args...>)
+        : basic_function{Alloc{}}
+    {
+        emplace_impl<T>(std::forward<Args>(args)...);
+    }
+
+    template <typename T, typename... Args,
+        DZE_REQUIRES(is_emplaceable_v<T, Args...>)>
+    basic_function(
+        std::allocator_arg_t, const Alloc& alloc, std::in_place_type_t<T>, Args&&... args)
+        noexcept(is_nothrow_emplaceable_v<T, Args...>)
+        : basic_function{alloc}
+    {
+        emplace_impl<T>(std::forward<Args>(args)...);
+    }
+
+    template <typename Callable,
+        DZE_REQUIRES(!is_function_v<Callable> && base::template is_convertible_v<Callable>)>
+    basic_function(allocated_t, Callable call, const Alloc& alloc = Alloc{})
+        noexcept(is_nothrow_allocatable_v)
+        : basic_function{alloc}
+    {
+        emplace_impl<Callable, false, true>(std::move(call));
+    }
+
+    template <typename T, typename... Args,
+        DZE_REQUIRES(is_emplaceable_v<T, Args...>)>
+    basic_function(
+        std::allocator_arg_t,
+        const Alloc& alloc,
+        allocated_t,
+        std::in_place_type_t<T>,
+        Args&&... args)
+        noexcept(std::is_nothrow_constructible_v<T, Args...> && is_nothrow_allocatable_v)
+        : basic_function{alloc}
+    {
+        emplace_impl<T, false, true>(std::forward<Args>(args)...);
+    }
 
     template <
         typename Member,
         typename Object,
-        typename = decltype(function{std::mem_fn(std::declval<Member Object::*>())})>
+        typename = decltype(basic_function{std::mem_fn(std::declval<Member Object::*>())})>
     // NOLINTNEXTLINE(readability-avoid-const-params-in-decls)
-    function(Member Object::*const ptr, const Alloc& alloc = Alloc{}) noexcept
-        : function{alloc}
+    basic_function(Member Object::*const ptr, const Alloc& alloc = Alloc{}) noexcept
+        : basic_function{alloc}
     {
         if (ptr)
             *this = std::mem_fn(ptr);
     }
 
-    function(const function&) = delete;
-    function& operator=(const function&) = delete;
+    basic_function(const basic_function&) = delete;
+    basic_function& operator=(const basic_function&) = delete;
 
     template <typename Signature2 = Signature,
         DZE_REQUIRES(is_movable_v<Signature2>)>
-    function(function<Signature2, Alloc>&& other) noexcept
+    basic_function(basic_function<Signature2, Size, Align, Alloc>&& other) noexcept
         : m_storage{std::move(other.m_storage)}
         , m_delegate{other.m_delegate}
     {
-        if (other.m_storage.allocated())
-            m_storage.move_allocated(other.m_storage);
+        if (other.bytewise_movable())
+            m_storage.relocate(other.m_storage);
         else
-        {
-            other.m_delegate.move(other.data_addr(), data_addr());
-            other.m_delegate.destroy(other.data_addr());
-        }
+            relocate_inline(other, *this);
         other.m_delegate.reset();
     }
 
+    // Takes over the allocation of other only if alloc compares equal to its allocator.
+    template <typename Signature2 = Signature,
+        DZE_REQUIRES(is_movable_v<Signature2>)>
+    basic_function(basic_function<Signature2, Size, Align, Alloc>&& other, const Alloc& alloc)
+        noexcept(is_nothrow_allocatable_v)
+        : basic_function{alloc}
+    {
+        adopt(other);
+    }
+
     template <
         typename Signature2 = Signature,
+        size_t Size2 = Size,
+        size_t Align2 = Align,
         typename Alloc2 = Alloc,
         DZE_REQUIRES(
-            !is_movable_v<Signature2> &&
-            base::template is_convertible_v<function<Signature2>>)>
-    function(function<Signature2, Alloc2>&& other, const Alloc& alloc = Alloc{})
-        noexcept(
-            std::is_nothrow_constructible_v<function, decltype(other), const Alloc&, conv_tag_t>)
-        : function{std::move(other), alloc, conv_tag_t{}} {}
+            !(is_movable_v<Signature2> && Size2 == Size && Align2 == Align &&
+                std::is_same_v<Alloc2, Alloc>) &&
+            base::template is_convertible_v<basic_function<Signature2, Size2, Align2, Alloc2>>)>
+    basic_function(
+        basic_function<Signature2, Size2, Align2, Alloc2>&& other, const Alloc& alloc = Alloc{})
+        noexcept(is_nothrow_allocatable_v)
+        : basic_function{alloc}
+    {
+        if constexpr (is_movable_v<Signature2>)
+        {
+            if (adopt(other))
+                return;
+        }
+        assign(std::move(other));
+    }
 
     template <typename Signature2 = Signature,
         DZE_REQUIRES(is_movable_v<Signature2>)>
-    function& operator=(function<Signature2, Alloc>&& other)
-        noexcept(noexcept(this->m_storage.resize(0, 0)))
+    basic_function& operator=(basic_function<Signature2, Size, Align, Alloc>&& other)
+        noexcept(is_nothrow_allocatable_v)
     {
         using alloc_traits = std::allocator_traits<Alloc>;
 
         m_delegate.destroy(data_addr());
-        m_delegate = other.m_delegate;
-        if (other.m_storage.allocated())
+        m_delegate.clear();
+        if (other.m_delegate.allocated())
         {
             if constexpr (alloc_traits::propagate_on_container_move_assignment::value)
             {
-                m_storage.deallocate();
+                release();
                 m_storage.move_allocator(other.m_storage);
                 m_storage.move_allocated(other.m_storage);
             }
             else if constexpr (alloc_traits::is_always_equal::value)
             {
-                m_storage.deallocate();
+                release();
                 m_storage.move_allocated(other.m_storage);
             }
             else
             {
                 if (m_storage.get_allocator() == other.m_storage.get_allocator())
                 {
-                    m_storage.deallocate();
+                    release();
                     m_storage.move_allocated(other.m_storage);
                 }
                 else
                 {
-                    m_storage.resize(
+                    // other keeps its allocation.
+                    if (!other)
+                        return *this;
+
+                    reserve_allocated(
                         other.m_storage.allocated_size(), other.m_storage.allocated_alignment());
-                    other.m_delegate.move(other.data_addr(), data_addr());
-                    other.m_delegate.destroy(other.data_addr());
+                    other.m_delegate.relocate(
+                        other.data_addr(), data_addr(), other.m_storage.allocated_size());
+                    m_delegate = other.m_delegate;
+                    other.m_delegate.reset_allocated();
+                    return *this;
                 }
             }
         }
         else
         {
-            other.m_delegate.move(other.data_addr(), data_addr());
-            other.m_delegate.destroy(other.data_addr());
+            release();
+            if (other.m_delegate.trivially_movable())
+                m_storage.relocate(other.m_storage);
+            else
+                relocate_inline(other, *this);
         }
+        m_delegate = other.m_delegate;
         other.m_delegate.reset();
         return *this;
     }
 
-    template <typename Signature2 = Signature, typename Alloc2 = Alloc,
+    template <
+        typename Signature2 = Signature,
+        size_t Size2 = Size,
+        size_t Align2 = Align,
+        typename Alloc2 = Alloc,
         DZE_REQUIRES(
-            !is_movable_v<Signature2> &&
-            base::template is_convertible_v<function<Signature2>>)>
-    function& operator=(function<Signature2, Alloc2>&& other)
-        noexcept(noexcept(this->assign(std::move(other))))
+            !(is_movable_v<Signature2> && Size2 == Size && Align2 == Align &&
+                std::is_same_v<Alloc2, Alloc>) &&
+            base::template is_convertible_v<basic_function<Signature2, Size2, Align2, Alloc2>>)>
+    basic_function& operator=(basic_function<Signature2, Size2, Align2, Alloc2>&& other)
+        noexcept(is_nothrow_allocatable_v)
     {
+        if constexpr (is_movable_v<Signature2>)
+        {
+            if (adopt(other))
+                return *this;
+        }
         assign(std::move(other));
         return *this;
     }
 
-    ~function() { m_delegate.destroy(data_addr()); }
+    ~basic_function()
+    {
+        m_delegate.destroy(data_addr());
+        if (m_delegate.allocated())
+            m_storage.deallocate();
+    }
 
-    // Undefined behavior if std::allocator_traits<Alloc>::propagate_on_container_swap == false
-    // and both allocators do not compare equal.
-    void swap(function& other) noexcept(noexcept(this->m_storage.resize(0, 0)))
+    // Allocators are exchanged as if by move assignment. When they are not exchanged and do
+    // not compare equal, allocated callables are moved to memory from the other allocator.
+    void swap(basic_function& other) noexcept(is_nothrow_allocatable_v)
     {
         using alloc_traits = std::allocator_traits<Alloc>;
 
-        std::swap(m_delegate, other.m_delegate);
-        alignas(std::max_align_t) std::byte temp[decltype(m_storage)::max_inline_size()];
-        if (other.m_storage.allocated())
-        {
-            if (m_storage.allocated())
-            {
-                if constexpr (alloc_traits::propagate_on_container_swap::value)
-                {
-                    m_storage.swap_allocator(other.m_storage);
-                    m_storage.swap_allocated(other.m_storage);
-                }
-                else if constexpr (alloc_traits::is_always_equal::value)
-                    m_storage.swap_allocated(other.m_storage);
-                else
-                {
-                    if (m_storage.get_allocator() == other.m_storage.get_allocator())
-                        m_storage.swap_allocated(other.m_storage);
-                    else
-                        assert(false);
-                }
-            }
-            else
-            {
-                other.m_delegate.move(data_addr(), temp);
-                swap_helper(*this, other);
-                other.m_delegate.move(temp, other.data_addr());
-            }
-        }
-        else
+        if (bytewise_movable() && other.bytewise_movable() &&
+            (alloc_traits::is_always_equal::value ||
+                (!m_delegate.allocated() && !other.m_delegate.allocated())))
         {
-            m_delegate.move(other.data_addr(), temp);
-            if (m_storage.allocated())
-                swap_helper(other, *this);
-            else
-                other.m_delegate.move(data_addr(), other.data_addr());
-            m_delegate.move(temp, data_addr());
+            std::swap(m_delegate, other.m_delegate);
+            m_storage.swap_inline(other.m_storage);
+            return;
         }
+
+        basic_function temp{std::move(other)};
+        other = std::move(*this);
+        *this = std::move(temp);
     }
 
-    function& operator=(std::nullptr_t) noexcept
+    basic_function& operator=(std::nullptr_t) noexcept
     {
         m_delegate.destroy(data_addr());
-        m_delegate.reset();
+        m_delegate.clear();
         return *this;
     }
 
     template <typename Callable,
         DZE_REQUIRES(!is_function_v<Callable> && base::template is_convertible_v<Callable>)>
-    function& operator=(Callable call) noexcept(noexcept(this->assign(std::move(call))))
+    basic_function& operator=(Callable call) noexcept(noexcept(this->assign(std::move(call))))
     {
         assign(std::move(call));
         return *this;
@@ -311,103 +522,453 @@ public:
     template <
         typename Member,
         typename Object,
-        typename = decltype(function{std::mem_fn(std::declval<Member Object::*>())})>
-    function& operator=(Member Object::*const ptr) noexcept
+        typename = decltype(basic_function{std::mem_fn(std::declval<Member Object::*>())})>
+    basic_function& operator=(Member Object::*const ptr) noexcept
     {
         *this = ptr ? std::mem_fn(ptr) : nullptr;
         return *this;
     }
 
+    // Destroys the stored callable, if any, then constructs a T from args directly in its
+    // final storage. If that throws, this object is left empty.
+    template <typename T, typename... Args,
+        DZE_REQUIRES(is_emplaceable_v<T, Args...>)>
+    T& emplace(Args&&... args) noexcept(is_nothrow_emplaceable_v<T, Args...>)
+    {
+        return emplace_impl<T>(std::forward<Args>(args)...);
+    }
+
     explicit operator bool() const noexcept { return !m_delegate.empty(); }
 
     // Deallcates storage if there is no callable object stored.
     void shrink_to_fit() noexcept
     {
         if (!*this)
-            m_storage.deallocate();
+            release();
+    }
+
+    // Allocates memory for callables of up to size bytes aligned to at most alignment,
+    // unless they fit inline or the allocation of this object is big enough already.
+    // Callables that fit in the allocation are then stored in it, including those that
+    // would fit inline, until shrink_to_fit is called while this object is empty. Assigning
+    // nullptr keeps the allocation.
+    // A callable stored in a smaller allocation is moved to the new one. Nothing is
+    // reserved while a callable is stored inline, because its vtable only knows how to
+    // handle it inline.
+    void reserve(const size_t size, const size_t alignment = alignof(std::max_align_t))
+        noexcept(is_nothrow_allocatable_v)
+    {
+        if (m_delegate.allocated())
+        {
+            if (size <= m_storage.allocated_size() &&
+                alignment <= m_storage.allocated_alignment())
+            {
+                return;
+            }
+        }
+        else if (*this || storage_type::fits_inline(size, alignment))
+            return;
+
+        if (!*this)
+        {
+            reserve_allocated(size, alignment);
+            return;
+        }
+
+        storage_type old{m_storage.get_allocator()};
+        old.move_allocated(m_storage);
+        m_storage.allocate(size, alignment);
+        m_delegate.relocate(
+            old.allocated_data(), m_storage.allocated_data(), old.allocated_size());
+        old.deallocate();
+    }
+
+    // Number of bytes that callables can take without a new allocation, whether they are
+    // stored inline or in the allocation of this object.
+    [[nodiscard]] size_t capacity() const noexcept
+    {
+        return m_delegate.allocated()
+            ? std::max(m_storage.allocated_size(), storage_type::max_inline_size())
+            : storage_type::max_inline_size();
+    }
+
+    // True if this object has no allocation, so its callable, if any, is stored inline.
+    [[nodiscard]] bool is_inline() const noexcept { return !m_delegate.allocated(); }
+
+    // Returns the stored callable if it is a T, otherwise null. See call_if.
+    template <typename T>
+    [[nodiscard]] T* target() noexcept
+    {
+        return m_delegate.template holds<T>() ? static_cast<T*>(data_addr()) : nullptr;
+    }
+
+    template <typename T>
+    [[nodiscard]] const T* target() const noexcept
+    {
+        return m_delegate.template holds<T>() ? static_cast<const T*>(data_addr()) : nullptr;
+    }
+
+    // True if this object can be relocated by copying its bytes, which is the case if it
+    // is empty or its callable is allocated or trivially relocatable, and the allocator is
+    // trivially relocatable. See uninitialized_relocate.
+    [[nodiscard]] bool trivially_relocatable() const noexcept
+    {
+        return is_trivially_relocatable_v<Alloc> && bytewise_movable();
     }
 
 private:
     using delegate_type = typename base::delegate_type;
+    using storage_type = details::function_ns::storage<Size, Align, Alloc>;
+
+    static constexpr bool is_nothrow_allocatable_v =
+        noexcept(std::declval<storage_type&>().allocate(0, 0));
+
+    // Callables that may throw when moved are allocated, so that moving this object does
+    // not throw, unless the allocators do not compare equal.
+    template <typename T>
+    static constexpr bool is_stored_inline_v =
+        storage_type::fits_inline(sizeof(T), alignof(T)) &&
+        (is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>);
+
+    template <typename T, typename... Args>
+    static constexpr bool is_nothrow_emplaceable_v =
+        std::is_nothrow_constructible_v<T, Args...> &&
+        (is_stored_inline_v<T> || is_nothrow_allocatable_v);
 
     friend base;
-    friend class function<typename base::mut_signature, Alloc>;
+    template <typename, size_t, size_t, typename>
+    friend class basic_function;
+
+    template <typename, typename>
+    friend struct function_fits_inline;
+
+    template <typename, size_t, size_t, typename>
+    friend class basic_copyable_function;
+
+    template <bool, bool, typename, typename...>
+    friend class details::function_ns::ref_base;
+
+    template <typename, size_t, typename>
+    friend class details::function_ns::overload;
 
-    friend bool operator==(const function& f, std::nullptr_t) noexcept
+    friend struct details::function_ns::batch_access;
+
+    friend bool operator==(const basic_function& f, std::nullptr_t) noexcept
     {
         return !f;
     }
 
-    friend bool operator==(std::nullptr_t, const function& f) noexcept
+    friend bool operator==(std::nullptr_t, const basic_function& f) noexcept
     {
         return !f;
     }
 
-    friend bool operator!=(const function& f, std::nullptr_t) noexcept
+    friend bool operator!=(const basic_function& f, std::nullptr_t) noexcept
     {
         return static_cast<bool>(f);
     }
 
-    friend bool operator!=(std::nullptr_t, const function& f) noexcept
+    friend bool operator!=(std::nullptr_t, const basic_function& f) noexcept
     {
         return static_cast<bool>(f);
     }
 
-    details::function_ns::storage<
-        80 - 1 - sizeof(delegate_type), alignof(std::max_align_t), Alloc> m_storage;
+    // The storage must be the first member for its inline buffer to be aligned.
+    storage_type m_storage;
     delegate_type m_delegate;
 
-    template <typename Callable>
-    function(Callable&& call, const Alloc& alloc, conv_tag_t)
-        noexcept(std::is_nothrow_constructible_v<
-            decltype(this->m_storage), size_t, size_t, const Alloc&>)
-        : m_storage{sizeof(std::decay_t<Callable>), alignof(std::decay_t<Callable>), alloc}
+    template <typename Callable, bool Copyable = false>
+    basic_function(
+        Callable&& call, const Alloc& alloc, conv_tag_t, std::bool_constant<Copyable> = {})
+        noexcept(is_nothrow_allocatable_v)
+        : basic_function{alloc}
     {
-        m_delegate.template set<Callable, base::is_const>();
-        ::new (data_addr()) std::decay_t<Callable>{std::move(call)};
+        assign<Copyable>(std::move(call));
     }
 
-    template <typename Callable>
-    void assign(Callable&& call)
-        noexcept(noexcept(
-            m_storage.resize(sizeof(std::decay_t<Callable>), alignof(std::decay_t<Callable>))))
+    template <bool Copyable = false, typename Callable>
+    void assign(Callable&& call) noexcept(is_nothrow_allocatable_v)
     {
-        m_delegate.destroy(data_addr());
-        m_delegate.template set<Callable, base::is_const>();
-        m_storage.resize(sizeof(std::decay_t<Callable>), alignof(std::decay_t<Callable>));
-        ::new (data_addr()) std::decay_t<Callable>{std::move(call)};
+        emplace_impl<std::decay_t<Callable>, Copyable>(std::move(call));
     }
 
-    [[nodiscard]] const void* data_addr() const noexcept { return m_storage.data(); }
+    // Allocated callables are stored in allocated memory even if they fit inline.
+    // Callables that fit inline are also stored in the allocation of this object, if there
+    // is one and it is big enough, so that the allocation is kept for later callables.
+    template <typename T, bool Copyable = false, bool Allocated = false, typename... Args>
+    T& emplace_impl(Args&&... args)
+        noexcept(is_nothrow_emplaceable_v<T, Args...> &&
+            (!Allocated || is_nothrow_allocatable_v))
+    {
+        m_delegate.destroy(data_addr());
+        m_delegate.clear();
+        if constexpr (Allocated || !is_stored_inline_v<T>)
+        {
+            reserve_allocated(sizeof(T), alignof(T));
+            return construct<T, Copyable, true>(std::forward<Args>(args)...);
+        }
+        else
+        {
+            if (m_delegate.allocated())
+            {
+                if (m_storage.allocated_size() >= sizeof(T) &&
+                    m_storage.allocated_alignment() >= alignof(T))
+                {
+                    return construct<T, Copyable, true>(std::forward<Args>(args)...);
+                }
+                release();
+            }
+            return construct<T, Copyable, false>(std::forward<Args>(args)...);
+        }
+    }
 
-    [[nodiscard]] void* data_addr() noexcept { return m_storage.data(); }
+    // Pre-condition: This object is empty and has an allocation that fits a T if Allocated.
+    template <typename T, bool Copyable, bool Allocated, typename... Args>
+    T& construct(Args&&... args) noexcept(std::is_nothrow_constructible_v<T, Args...>)
+    {
+        void* const data = Allocated ? m_storage.allocated_data() : m_storage.inline_data();
+        auto& result = *::new (data) T(std::forward<Args>(args)...);
+        m_delegate.template set<T, base::is_const, Copyable, Allocated>();
+        return result;
+    }
 
-    static void swap_helper(function& lhs, function& rhs)
-        noexcept(noexcept(lhs.m_storage.resize(0, 0)))
+    // Takes over the callable of other, instead of wrapping other.
+    // The allocation of other is taken over if the allocators compare equal. Otherwise the
+    // callable is moved to an allocation of this object and other keeps its allocation.
+    // Returns false and leaves both objects untouched if the callable is stored inline in
+    // other and the inline buffer of other does not fit in this one.
+    template <typename Signature2, size_t Size2, size_t Align2, typename Alloc2>
+    bool adopt(basic_function<Signature2, Size2, Align2, Alloc2>& other)
+        noexcept(is_nothrow_allocatable_v)
     {
         using alloc_traits = std::allocator_traits<Alloc>;
+        using other_storage_type = details::function_ns::storage<Size2, Align2, Alloc2>;
 
-        if constexpr (alloc_traits::propagate_on_container_move_assignment::value)
+        constexpr bool other_fits_inline = storage_type::fits_inline(
+            other_storage_type::max_inline_size(), other_storage_type::max_inline_alignment());
+
+        if constexpr (!other_fits_inline)
         {
-            lhs.m_storage.move_allocator(rhs.m_storage);
-            lhs.m_storage.move_allocated(rhs.m_storage);
+            if (other && !other.m_delegate.allocated())
+                return false;
         }
-        else if constexpr (alloc_traits::is_always_equal::value)
-            lhs.m_storage.move_allocated(rhs.m_storage);
-        else
+
+        m_delegate.destroy(data_addr());
+        m_delegate.clear();
+        if (!other)
+            return true;
+
+        // Otherwise the callable of other is allocated, see above. Not compiling this
+        // branch keeps the copy of the inline buffer of other within this one.
+        if constexpr (other_fits_inline)
         {
-            if (lhs.m_storage.get_allocator() == rhs.m_storage.get_allocator())
-                lhs.m_storage.move_allocated(rhs.m_storage);
-            else
+            if (!other.m_delegate.allocated())
+            {
+                release();
+                other.m_delegate.relocate(
+                    other.m_storage.inline_data(), m_storage.inline_data(),
+                    other.m_storage.max_inline_size());
+                m_delegate = other.m_delegate;
+                other.m_delegate.reset();
+                return true;
+            }
+        }
+
+        if constexpr (std::is_same_v<Alloc2, Alloc>)
+        {
+            if (alloc_traits::is_always_equal::value ||
+                m_storage.get_allocator() == other.m_storage.get_allocator())
             {
-                lhs.m_storage.resize(
-                    rhs.m_storage.allocated_size(), rhs.m_storage.allocated_alignment());
-                lhs.m_delegate.move(rhs.data_addr(), lhs.data_addr());
+                release();
+                m_storage.move_allocated(other.m_storage);
+                m_delegate = other.m_delegate;
+                other.m_delegate.reset();
+                return true;
             }
         }
+
+        reserve_allocated(
+            other.m_storage.allocated_size(), other.m_storage.allocated_alignment());
+        other.m_delegate.relocate(
+            other.data_addr(), data_addr(), other.m_storage.allocated_size());
+        m_delegate = other.m_delegate;
+        other.m_delegate.reset_allocated();
+        return true;
+    }
+
+    // Copies the callable of other into this object.
+    // Pre-condition: This object is empty and other stores a copyable callable, if any.
+    template <typename Signature2>
+    void copy_from(const basic_function<Signature2, Size, Align, Alloc>& other)
+    {
+        // Neither the inline buffer nor the allocation kept by an empty object is copied,
+        // nothing may have been written to them.
+        if (other.m_delegate.empty())
+            return;
+
+        size_t size = storage_type::max_inline_size();
+        if (other.m_delegate.allocated())
+        {
+            size = other.m_storage.allocated_size();
+            reserve_allocated(size, other.m_storage.allocated_alignment());
+        }
+        else
+            release();
+        other.m_delegate.copy(other.data_addr(), data_addr(), size);
+        m_delegate = other.m_delegate;
+    }
+
+    // Makes sure there is an allocation of at least size bytes aligned to alignment.
+    // Pre-condition: This object is empty.
+    void reserve_allocated(const size_t size, const size_t alignment)
+        noexcept(is_nothrow_allocatable_v)
+    {
+        if (m_delegate.allocated())
+            m_storage.reallocate(size, alignment);
+        else
+        {
+            m_storage.allocate(size, alignment);
+            m_delegate.reset_allocated();
+        }
+    }
+
+    // Deallocates the retained allocation, if any.
+    // Pre-condition: This object is empty.
+    void release() noexcept
+    {
+        if (m_delegate.allocated())
+        {
+            m_storage.deallocate();
+            m_delegate.reset();
+        }
+    }
+
+    [[nodiscard]] const void* data_addr() const noexcept
+    {
+        return m_delegate.allocated() ? m_storage.allocated_data() : m_storage.inline_data();
+    }
+
+    [[nodiscard]] void* data_addr() noexcept
+    {
+        return m_delegate.allocated() ? m_storage.allocated_data() : m_storage.inline_data();
+    }
+
+    // Address passed to the call operation of the delegate.
+    // It does not depend on whether the callable is allocated, so calls do not branch on it.
+    [[nodiscard]] const void* call_addr() const noexcept { return m_storage.inline_data(); }
+
+    [[nodiscard]] void* call_addr() noexcept { return m_storage.inline_data(); }
+
+    // True if the state of this object can be moved by copying the inline buffer.
+    [[nodiscard]] bool bytewise_movable() const noexcept
+    {
+        return m_delegate.allocated() || m_delegate.trivially_movable();
+    }
+
+    // Pre-condition: from stores its callable inline and to has no allocation.
+    template <typename Signature2>
+    static void relocate_inline(
+        basic_function<Signature2, Size, Align, Alloc>& from, basic_function& to) noexcept
+    {
+        from.m_delegate.relocate(
+            from.m_storage.inline_data(), to.m_storage.inline_data(),
+            storage_type::max_inline_size());
     }
 };
 
+template <typename Signature, size_t Size, size_t Align, typename Alloc, typename Callable>
+struct function_fits_inline<basic_function<Signature, Size, Align, Alloc>, Callable>
+    : std::bool_constant<basic_function<Signature, Size, Align, Alloc>::template
+        is_stored_inline_v<std::decay_t<Callable>>> {};
+
+// basic_function with the default inline storage size and alignment.
+template <typename Signature, typename Alloc = allocator>
+class function
+    : public basic_function<
+        Signature,
+        details::function_ns::default_size,
+        details::function_ns::default_alignment,
+        Alloc>
+{
+    using base = basic_function<
+        Signature,
+        details::function_ns::default_size,
+        details::function_ns::default_alignment,
+        Alloc>;
+
+public:
+    using base::base;
+
+    function() = default;
+
+    // Forwards to the assignments of basic_function, but returns this type.
+    template <typename T, DZE_REQUIRES(std::is_assignable_v<base&, T&&>)>
+    function& operator=(T&& value) noexcept(std::is_nothrow_assignable_v<base&, T&&>)
+    {
+        base::operator=(std::forward<T>(value));
+        return *this;
+    }
+};
+
+// Constructs a function that stores a T made from args directly in its final storage.
+template <typename Signature, typename T, typename Alloc, typename... Args>
+function<Signature, Alloc> make_function(const Alloc& alloc, Args&&... args)
+    noexcept(std::is_nothrow_constructible_v<
+        function<Signature, Alloc>,
+        std::allocator_arg_t,
+        const Alloc&,
+        std::in_place_type_t<T>,
+        Args&&...>)
+{
+    return function<Signature, Alloc>{
+        std::allocator_arg, alloc, std::in_place_type<T>, std::forward<Args>(args)...};
+}
+
+template <typename Signature, typename Alloc, typename Callable>
+struct function_fits_inline<function<Signature, Alloc>, Callable>
+    : function_fits_inline<
+        basic_function<
+            Signature,
+            details::function_ns::default_size,
+            details::function_ns::default_alignment,
+            Alloc>,
+        Callable> {};
+
+static_assert(sizeof(void*) != 8 || sizeof(function<void()>) == 80);
+static_assert(sizeof(function<void()>) == sizeof(function<int(int, int) const noexcept>));
+
+// Layouts that line up with cache lines in arrays, unlike function, which is aligned to
+// alignof(std::max_align_t) only and straddles two cache lines in most slots of an array.
+// The sizes hold for allocators without state, like the default one.
+
+// Two per cache line.
+template <typename Signature, typename Alloc = allocator>
+using compact_function =
+    basic_function<Signature, details::function_ns::preset_size<32>, 32, Alloc>;
+
+// One per cache line.
+template <typename Signature, typename Alloc = allocator>
+using cache_line_function = basic_function<
+    Signature,
+    details::function_ns::preset_size<details::function_ns::cache_line_size>,
+    details::function_ns::cache_line_size,
+    Alloc>;
+
+// Two cache lines.
+template <typename Signature, typename Alloc = allocator>
+using large_function = basic_function<
+    Signature,
+    details::function_ns::preset_size<2 * details::function_ns::cache_line_size>,
+    details::function_ns::cache_line_size,
+    Alloc>;
+
+static_assert(sizeof(compact_function<void()>) == 32);
+static_assert(alignof(compact_function<void()>) == 32);
+static_assert(sizeof(cache_line_function<void()>) == details::function_ns::cache_line_size);
+static_assert(alignof(cache_line_function<void()>) == details::function_ns::cache_line_size);
+static_assert(sizeof(large_function<void()>) == 2 * details::function_ns::cache_line_size);
+static_assert(alignof(large_function<void()>) == details::function_ns::cache_line_size);
+
 template <typename R, typename... Args, typename Alloc = allocator>
 function(R(*)(Args...), Alloc = Alloc{}) -> function<R(Args...) const, Alloc>;
 
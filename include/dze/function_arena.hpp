@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "function.hpp"
+
+namespace dze {
+
+// Bump allocator for the callables of functions that live for the same scope, for
+// example the callbacks of a request.
+// Memory is only given back by release, all at once. The last chunk is kept, so a scope
+// that is reused does not allocate once the chunk is big enough.
+class function_arena
+{
+    struct chunk_header
+    {
+        chunk_header* prev;
+        size_t size;
+    };
+
+public:
+    explicit function_arena(const size_t initial_size = 4096) noexcept
+        : m_next_size{std::max(initial_size, 2 * sizeof(chunk_header))} {}
+
+    function_arena(const function_arena&) = delete;
+    function_arena& operator=(const function_arena&) = delete;
+
+    ~function_arena()
+    {
+        release();
+        if (m_chunk)
+            free_chunk(m_chunk);
+    }
+
+    // Pre-condition: size is not 0.
+    [[nodiscard]] void* allocate_bytes(const size_t size, const size_t alignment)
+    {
+        // Without a chunk, m_pos and m_end are 0 and the allocation does not fit.
+        auto pos = align(m_pos, alignment);
+        if (pos + size > m_end)
+            pos = add_chunk(size, alignment);
+
+        m_pos = pos + size;
+        return reinterpret_cast<void*>(pos);
+    }
+
+    // Rewinds to the beginning of the last chunk and frees the others.
+    // Pre-condition: The functions that allocated from this arena are only destroyed
+    // afterwards, and those that hold callables that are not trivially destructible have
+    // been destroyed already.
+    void release() noexcept
+    {
+        if (!m_chunk)
+            return;
+
+        while (m_chunk->prev)
+        {
+            auto* const prev = m_chunk->prev;
+            m_chunk->prev = prev->prev;
+            free_chunk(prev);
+        }
+
+        m_pos = begin(m_chunk);
+    }
+
+private:
+    chunk_header* m_chunk = nullptr;
+    std::uintptr_t m_pos = 0;
+    std::uintptr_t m_end = 0;
+    size_t m_next_size;
+
+    [[nodiscard]] static std::uintptr_t align(
+        const std::uintptr_t pos, const size_t alignment) noexcept
+    {
+        return (pos + alignment - 1) & ~(std::uintptr_t{alignment} - 1);
+    }
+
+    [[nodiscard]] static std::uintptr_t begin(chunk_header* const chunk) noexcept
+    {
+        return reinterpret_cast<std::uintptr_t>(chunk + 1);
+    }
+
+    // The chunks grow geometrically, and are big enough for at least size bytes aligned
+    // to alignment after the header.
+    // Returns the aligned position of the allocation in the new chunk.
+    std::uintptr_t add_chunk(const size_t size, const size_t alignment)
+    {
+        const size_t chunk_size =
+            std::max(m_next_size, size + alignment + sizeof(chunk_header));
+        auto* const chunk = static_cast<chunk_header*>(::operator new(chunk_size));
+        ::new (chunk) chunk_header{m_chunk, chunk_size};
+
+        m_chunk = chunk;
+        m_end = reinterpret_cast<std::uintptr_t>(chunk) + chunk_size;
+        m_next_size = 2 * chunk_size;
+        return align(begin(chunk), alignment);
+    }
+
+    static void free_chunk(chunk_header* const chunk) noexcept
+    {
+        ::operator delete(chunk, chunk->size);
+    }
+};
+
+// Allocator of functions whose callables are allocated from a function_arena.
+// Deallocating does nothing, so the destructor of a function is reduced to destroying
+// the callable, which is skipped for trivially destructible callables.
+class arena_allocator
+{
+public:
+    using value_type = std::byte;
+
+    arena_allocator(function_arena* const arena) noexcept
+        : m_arena{arena} {}
+
+    [[nodiscard]] void* allocate_bytes(const size_t size, const size_t alignment)
+    {
+        return m_arena->allocate_bytes(size, alignment);
+    }
+
+    void deallocate_bytes(void*, size_t, size_t) noexcept {}
+
+    [[nodiscard]] function_arena* arena() const noexcept { return m_arena; }
+
+    friend bool operator==(const arena_allocator& l, const arena_allocator& r) noexcept
+    {
+        return l.m_arena == r.m_arena;
+    }
+
+    friend bool operator!=(const arena_allocator& l, const arena_allocator& r) noexcept
+    {
+        return !(l == r);
+    }
+
+private:
+    function_arena* m_arena;
+};
+
+namespace arena {
+
+template <typename Signature>
+using function = ::dze::function<Signature, arena_allocator>;
+
+} // namespace arena
+
+} // namespace dze
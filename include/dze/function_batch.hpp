@@ -0,0 +1,98 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <iterator>
+
+#include "function.hpp"
+#include "inplace_function.hpp"
+
+namespace dze {
+
+namespace details::function_ns {
+
+// Number of functions ahead of the one being called that invoke_all prefetches.
+inline constexpr size_t prefetch_distance = 8;
+
+struct batch_access
+{
+    template <typename Function>
+    [[nodiscard]] static const void* vtable(const Function& f) noexcept
+    {
+        return f.m_delegate.vtable();
+    }
+
+    template <typename Function>
+    static void prefetch_vtable(const Function& f) noexcept
+    {
+        prefetch(f.m_delegate.vtable());
+    }
+
+    // Prefetches what the first pointer in the inline buffer points to. That is the
+    // allocation of an allocated callable, and for an inline callable whatever its first
+    // bytes point to if they are a pointer, which is harmless otherwise. Not branching on
+    // whether the callable is allocated is what makes this cheaper than the misses it saves.
+    // The callable of an inplace_function is in the object itself.
+    template <typename Function>
+    static void prefetch_payload(const Function& f) noexcept
+    {
+        if constexpr (!is_inplace_function_v<Function>)
+        {
+            const void* p;
+            std::memcpy(&p, f.call_addr(), sizeof(p));
+            prefetch(p);
+        }
+    }
+};
+
+} // namespace details::function_ns
+
+// Calls each of functions with args, in order.
+// Functions is a contiguous range, like a std::vector or an array, of function,
+// copyable_function or inplace_function objects.
+// Arguments are passed to every function as lvalues, so by value arguments are copied and
+// none is moved from, while functions that take lvalue references may modify them.
+// While a function is called, the vtables and the allocated callables of the functions
+// that follow are prefetched.
+// Calls to callables of many types in random order are faster after group_by_stub.
+// Pre-condition: Each of functions stores a callable.
+template <typename Functions, typename... Args>
+void invoke_all(Functions& functions, Args&&... args)
+{
+    using details::function_ns::batch_access;
+    using details::function_ns::prefetch_distance;
+
+    auto* const first = std::data(functions);
+    const size_t size = std::size(functions);
+    for (size_t i = 0; i != size; ++i)
+    {
+        if (i + prefetch_distance < size)
+        {
+            batch_access::prefetch_vtable(first[i + prefetch_distance]);
+            batch_access::prefetch_payload(first[i + prefetch_distance]);
+        }
+        first[i](args...);
+    }
+}
+
+// Reorders functions so that the functions whose callables are called through the same
+// call stub, which are those that store callables of the same type the same way, are next
+// to each other. Calling them in that order calls each stub many times in a row, so its
+// indirect call is predicted, and its code stays in the instruction cache.
+// The order of the functions of each stub is kept. The order of the stubs is unspecified.
+// Functions is a range of function, copyable_function or inplace_function objects.
+template <typename Functions>
+void group_by_stub(Functions& functions)
+{
+    using details::function_ns::batch_access;
+
+    std::stable_sort(
+        std::begin(functions), std::end(functions), [] (const auto& a, const auto& b)
+        {
+            return std::less<const void*>{}(batch_access::vtable(a), batch_access::vtable(b));
+        });
+}
+
+} // namespace dze
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include <dze/type_traits.hpp>
+
+#include "details/function/storage.hpp"
+
+namespace dze {
+
+namespace details::function_ns {
+
+[[nodiscard]] inline size_t round_up_to_power_of_two(const size_t n) noexcept
+{
+    assert(n != 0);
+
+    size_t result = 1;
+    while (result < n)
+        result *= 2;
+    return result;
+}
+
+// The sequence number tells whether the slot is ready to be written or to be read for a
+// given position in the queue.
+template <typename T>
+struct alignas(cache_line_size) queue_slot
+{
+    std::atomic<size_t> sequence;
+    alignas(T) std::byte storage[sizeof(T)];
+
+    [[nodiscard]] T& get() noexcept { return *std::launder(reinterpret_cast<T*>(storage)); }
+};
+
+} // namespace details::function_ns
+
+// Bounded lock free multi producer multi consumer queue of functions.
+// Functions are moved straight into and out of their slot, so neither pushing nor popping
+// allocates, besides what moving a function may do. Each slot is on its own cache lines.
+// Function is usually a function or a copyable_function.
+template <typename Function>
+class function_queue
+{
+    static_assert(
+        std::is_nothrow_move_constructible_v<Function>,
+        "Functions must be moved into and out of slots without throwing.");
+
+    using slot_type = details::function_ns::queue_slot<Function>;
+
+public:
+    using value_type = Function;
+    using size_type = size_t;
+
+    // The capacity is rounded up to a power of two.
+    explicit function_queue(const size_type capacity)
+        : m_mask{details::function_ns::round_up_to_power_of_two(capacity) - 1}
+        , m_slots{new slot_type[m_mask + 1]}
+    {
+        for (size_t i = 0; i != m_mask + 1; ++i)
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    function_queue(const function_queue&) = delete;
+    function_queue& operator=(const function_queue&) = delete;
+
+    // Pre-condition: No other thread uses this object.
+    ~function_queue()
+    {
+        while (try_pop()) {}
+    }
+
+    // Returns false and leaves f alone if the queue is full.
+    [[nodiscard]] bool try_push(Function&& f) noexcept { return try_emplace(std::move(f)); }
+
+    // Constructs a Function from args in the next slot.
+    // Returns false if the queue is full.
+    template <typename... Args,
+        DZE_REQUIRES(std::is_nothrow_constructible_v<Function, Args&&...>)>
+    [[nodiscard]] bool try_emplace(Args&&... args) noexcept
+    {
+        size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        slot_type* slot;
+        for (;;)
+        {
+            slot = &m_slots[pos & m_mask];
+            const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            const auto diff =
+                static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos);
+            if (diff == 0)
+            {
+                if (m_enqueue_pos.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+                return false;
+            else
+                pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        }
+
+        ::new (slot->storage) Function{std::forward<Args>(args)...};
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns an empty optional if the queue is empty.
+    [[nodiscard]] std::optional<Function> try_pop() noexcept
+    {
+        size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        slot_type* slot;
+        for (;;)
+        {
+            slot = &m_slots[pos & m_mask];
+            const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            const auto diff =
+                static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos + 1);
+            if (diff == 0)
+            {
+                if (m_dequeue_pos.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+                return std::nullopt;
+            else
+                pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        }
+
+        std::optional<Function> result{std::move(slot->get())};
+        slot->get().~Function();
+        slot->sequence.store(pos + m_mask + 1, std::memory_order_release);
+        return result;
+    }
+
+    [[nodiscard]] size_type capacity() const noexcept { return m_mask + 1; }
+
+    // Only a snapshot when other threads use this object.
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return m_dequeue_pos.load(std::memory_order_relaxed) ==
+            m_enqueue_pos.load(std::memory_order_relaxed);
+    }
+
+private:
+    const size_t m_mask;
+    const std::unique_ptr<slot_type[]> m_slots;
+    alignas(details::function_ns::cache_line_size) std::atomic<size_t> m_enqueue_pos{0};
+    alignas(details::function_ns::cache_line_size) std::atomic<size_t> m_dequeue_pos{0};
+};
+
+} // namespace dze
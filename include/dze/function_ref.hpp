@@ -0,0 +1,179 @@
+#pragma once
+
+#include <cassert>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <dze/type_traits.hpp>
+
+#include "function.hpp"
+
+namespace dze {
+
+namespace details::function_ns {
+
+template <typename T, typename R, typename... Args>
+R ref_call_stub(void* const data, param_t<Args>... args)
+{
+    if constexpr (std::is_void_v<R>)
+        (*static_cast<T*>(data))(static_cast<Args&&>(args)...);
+    else
+        return (*static_cast<T*>(data))(static_cast<Args&&>(args)...);
+}
+
+template <typename Fn, typename R, typename... Args>
+R ref_fn_stub(void* const data, param_t<Args>... args)
+{
+    if constexpr (std::is_void_v<R>)
+        reinterpret_cast<Fn*>(data)(static_cast<Args&&>(args)...);
+    else
+        return reinterpret_cast<Fn*>(data)(static_cast<Args&&>(args)...);
+}
+
+template <bool Const, bool Noexcept, typename R, typename... Args>
+class ref_base
+{
+    template <typename T>
+    using object_t = std::conditional_t<Const, const T, T>;
+
+    template <typename T, typename = void>
+    struct is_invocable : std::false_type {};
+
+    template <typename T>
+    struct is_invocable<
+        T,
+        std::enable_if_t<
+            (Noexcept
+                ? std::is_nothrow_invocable_v<T&, Args...>
+                : std::is_invocable_v<T&, Args...>) &&
+            is_safely_convertible_v<std::invoke_result_t<T&, Args...>, R>>>
+        : std::true_type {};
+
+    // True if a pointer to the callable object of a function pointed to by T* can be used
+    // together with the call operation of its delegate.
+    template <bool Noexcept2, size_t Size, size_t Align, typename Alloc>
+    static constexpr bool bindable(
+        basic_function<R(Args...) noexcept(Noexcept2), Size, Align, Alloc>*) noexcept
+    {
+        return !Const && (Noexcept2 || !Noexcept);
+    }
+
+    template <bool Noexcept2, size_t Size, size_t Align, typename Alloc>
+    static constexpr bool bindable(
+        const basic_function<R(Args...) const noexcept(Noexcept2), Size, Align, Alloc>*) noexcept
+    {
+        return Noexcept2 || !Noexcept;
+    }
+
+    static constexpr bool bindable(...) noexcept { return false; }
+
+    template <typename T>
+    static constexpr bool is_bindable_v = bindable(static_cast<T*>(nullptr));
+
+public:
+    template <
+        typename Callable,
+        typename T = object_t<std::remove_reference_t<Callable>>,
+        DZE_REQUIRES(
+            !std::is_base_of_v<ref_base, std::decay_t<Callable>> &&
+            !std::is_function_v<std::remove_reference_t<Callable>> &&
+            !std::is_member_pointer_v<std::decay_t<Callable>> &&
+            !is_bindable_v<std::remove_reference_t<Callable>> &&
+            is_invocable<T>::value)>
+    ref_base(Callable&& call) noexcept
+        : m_object{const_cast<void*>(static_cast<const volatile void*>(std::addressof(call)))}
+        , m_call{&ref_call_stub<T, R, Args...>} {}
+
+    // Pre-condition: fn is not null.
+    template <typename Fn, DZE_REQUIRES(std::is_function_v<Fn> && is_invocable<Fn>::value)>
+    ref_base(Fn* const fn) noexcept
+        : m_object{reinterpret_cast<void*>(fn)}
+        , m_call{&ref_fn_stub<Fn, R, Args...>}
+    {
+        static_assert(sizeof(fn) == sizeof(void*));
+        assert(fn);
+    }
+
+    // Binds to the callable object currently stored in f, not to f itself,
+    // so calls do not go through the call operator of f.
+    // Assigning to f or moving from f invalidates this object.
+    template <typename Function,
+        DZE_REQUIRES(is_bindable_v<std::remove_reference_t<Function>>)>
+    ref_base(Function&& f) noexcept
+    {
+        bind(f);
+    }
+
+    // Pre-condition: The referenced object is alive and, if it is a function, not empty.
+    R operator()(Args... args) const noexcept(Noexcept)
+    {
+        return m_call(m_object, static_cast<Args&&>(args)...);
+    }
+
+private:
+    using call_t = typename vtable_t<R, Args...>::call_t;
+
+    void* m_object;
+    call_t* m_call;
+
+    template <typename Signature, size_t Size, size_t Align, typename Alloc>
+    void bind(const basic_function<Signature, Size, Align, Alloc>& f) noexcept
+    {
+        using fn_t = typename decltype(f.m_delegate)::fn_t;
+
+        if (f.m_delegate.direct())
+        {
+            auto* const fn = *static_cast<fn_t* const*>(f.call_addr());
+            m_object = reinterpret_cast<void*>(fn);
+            m_call = &ref_fn_stub<fn_t, R, Args...>;
+            return;
+        }
+
+        m_object = const_cast<void*>(f.call_addr());
+        m_call = f.m_delegate.get_call();
+    }
+};
+
+} // namespace details::function_ns
+
+template <typename>
+class function_ref;
+
+// Non-owning reference to a callable object.
+// Holds a pointer to the object and a pointer to a function that calls it,
+// so it is cheap to copy and never allocates.
+// The referenced object must outlive the function_ref.
+// A function_ref is never empty.
+template <bool Noexcept, typename R, typename... Args>
+class function_ref<R(Args...) noexcept(Noexcept)>
+    : public details::function_ns::ref_base<false, Noexcept, R, Args...>
+{
+    using base = details::function_ns::ref_base<false, Noexcept, R, Args...>;
+
+public:
+    using base::base;
+};
+
+template <bool Noexcept, typename R, typename... Args>
+class function_ref<R(Args...) const noexcept(Noexcept)>
+    : public details::function_ns::ref_base<true, Noexcept, R, Args...>
+{
+    using base = details::function_ns::ref_base<true, Noexcept, R, Args...>;
+
+public:
+    using base::base;
+};
+
+template <typename R, typename... Args>
+function_ref(R(*)(Args...)) -> function_ref<R(Args...) const>;
+
+template <typename R, typename... Args>
+function_ref(R(*)(Args...) noexcept) -> function_ref<R(Args...) const noexcept>;
+
+template <
+    typename Callable,
+    typename Signature = details::function_ns::guide_helper_t<std::decay_t<Callable>>>
+function_ref(Callable&&) -> function_ref<Signature>;
+
+} // namespace dze
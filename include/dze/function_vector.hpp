@@ -0,0 +1,454 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <dze/allocator.hpp>
+#include <dze/memory_resource.hpp>
+#include <dze/type_traits.hpp>
+
+#include "function.hpp"
+
+namespace dze {
+
+namespace details::function_ns {
+
+[[nodiscard]] constexpr size_t align_up(const size_t offset, const size_t alignment) noexcept
+{
+    return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+// The offsets are stored in the entry so that finding the next entry does not wait for
+// loading the vtable.
+template <typename VTable>
+struct entry_header
+{
+    const VTable* vtable;
+    // Offset of the callable from the header.
+    uint32_t payload;
+    // Offset of the next header from this one.
+    uint32_t size;
+};
+
+// Each entry is a header followed by the callable, aligned to its own alignment.
+// Offsets of entries are relative to the start of the buffer, which is aligned to the
+// strictest alignment of the callables, so growing only needs to relocate the entries
+// to the same offsets in the new buffer.
+template <typename Alloc, bool Const, bool Noexcept, typename R, typename... Args>
+class vector_base : private Alloc
+{
+    using vtable_type = vtable_t<R, Args...>;
+    using header_type = entry_header<vtable_type>;
+    using alloc_traits = std::allocator_traits<Alloc>;
+
+    template <typename T>
+    using object_t = std::conditional_t<Const, const T, T>;
+
+    // Arguments are passed to every callable, so by value arguments are copied from
+    // the arguments of the call operator instead of moved. Rvalue reference arguments are
+    // forwarded as such to every callable.
+    template <typename T>
+    using arg_t = std::conditional_t<std::is_rvalue_reference_v<T>, T, T&>;
+
+    template <typename T, typename = void>
+    struct is_invocable : std::false_type {};
+
+    template <typename T>
+    struct is_invocable<
+        T,
+        std::enable_if_t<
+            (Noexcept
+                ? std::is_nothrow_invocable_v<object_t<T>&, Args...>
+                : std::is_invocable_v<object_t<T>&, Args...>) &&
+            is_safely_convertible_v<std::invoke_result_t<object_t<T>&, Args...>, R>>>
+        : std::true_type {};
+
+    static constexpr size_t min_capacity = 256;
+
+public:
+    using allocator_type = Alloc;
+    using size_type = size_t;
+
+    // Refers to the callable of an entry and calls it.
+    // Adding callables to the vector or destroying them invalidates it.
+    class entry
+    {
+    public:
+        R operator()(Args... args) const noexcept(Noexcept)
+        {
+            return m_vtable->call(m_object, static_cast<Args&&>(args)...);
+        }
+
+    private:
+        friend class vector_base;
+
+        const vtable_type* m_vtable;
+        void* m_object;
+
+        entry(const vtable_type* const vtable, void* const object) noexcept
+            : m_vtable{vtable}
+            , m_object{object} {}
+    };
+
+    // Forward iterator over the entries, in the order they were added.
+    // Dereferencing it returns an entry by value.
+    class iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = entry;
+        using difference_type = ptrdiff_t;
+        using pointer = void;
+        using reference = entry;
+
+        iterator() noexcept = default;
+
+        [[nodiscard]] entry operator*() const noexcept
+        {
+            const auto& h = header();
+            return {h.vtable, m_header + h.payload};
+        }
+
+        iterator& operator++() noexcept
+        {
+            m_header += header().size;
+            return *this;
+        }
+
+        iterator operator++(int) noexcept
+        {
+            auto result = *this;
+            ++*this;
+            return result;
+        }
+
+        friend bool operator==(const iterator a, const iterator b) noexcept
+        {
+            return a.m_header == b.m_header;
+        }
+
+        friend bool operator!=(const iterator a, const iterator b) noexcept
+        {
+            return a.m_header != b.m_header;
+        }
+
+    private:
+        friend class vector_base;
+
+        std::byte* m_header = nullptr;
+
+        explicit iterator(std::byte* const header) noexcept
+            : m_header{header} {}
+
+        [[nodiscard]] const header_type& header() const noexcept
+        {
+            return *reinterpret_cast<const header_type*>(m_header);
+        }
+    };
+
+    vector_base() noexcept
+        : vector_base{Alloc{}} {}
+
+    vector_base(const Alloc& alloc) noexcept
+        : Alloc{alloc} {}
+
+    vector_base(const vector_base&) = delete;
+    vector_base& operator=(const vector_base&) = delete;
+
+    vector_base(vector_base&& other) noexcept
+        : Alloc{std::move(other.allocator())}
+    {
+        take(other);
+    }
+
+    vector_base& operator=(vector_base&& other)
+        noexcept(alloc_traits::propagate_on_container_move_assignment::value ||
+            alloc_traits::is_always_equal::value)
+    {
+        if (this == &other)
+            return *this;
+
+        clear();
+        if constexpr (
+            !alloc_traits::propagate_on_container_move_assignment::value &&
+            !alloc_traits::is_always_equal::value)
+        {
+            if (allocator() != other.allocator())
+            {
+                // other keeps its buffer.
+                if (other.empty())
+                    return *this;
+
+                if (other.m_size > m_capacity || other.m_alignment > m_alignment)
+                    reallocate(std::max(other.m_size, m_capacity), other.m_alignment);
+                other.relocate_to(m_data);
+                m_size = std::exchange(other.m_size, 0);
+                m_count = std::exchange(other.m_count, 0);
+                m_trivially_relocatable = std::exchange(other.m_trivially_relocatable, true);
+                m_trivially_destructible = std::exchange(other.m_trivially_destructible, true);
+                return *this;
+            }
+        }
+
+        deallocate();
+        if constexpr (alloc_traits::propagate_on_container_move_assignment::value)
+            allocator() = std::move(other.allocator());
+        take(other);
+        return *this;
+    }
+
+    ~vector_base()
+    {
+        clear();
+        deallocate();
+    }
+
+    template <typename Callable,
+        DZE_REQUIRES(is_invocable<std::decay_t<Callable>>::value)>
+    void push_back(Callable&& call)
+    {
+        emplace_back<std::decay_t<Callable>>(std::forward<Callable>(call));
+    }
+
+    // Constructs a Callable from args at the end of the buffer.
+    // Provides the strong exception guarantee, except that the buffer may have grown.
+    template <typename Callable, typename... CallableArgs,
+        DZE_REQUIRES(is_invocable<Callable>::value)>
+    Callable& emplace_back(CallableArgs&&... args)
+    {
+        static_assert(sizeof(Callable) <= UINT32_MAX / 2, "Callable is too big.");
+        static_assert(
+            is_trivially_relocatable_v<Callable> || std::is_nothrow_move_constructible_v<Callable>,
+            "Moving the callable may throw, but growing a function_vector must not.");
+
+        const auto& vtable = vtable_for<Callable, Const, Noexcept, false, false, R, Args...>;
+
+        const size_t payload = align_up(m_size + sizeof(header_type), alignof(Callable));
+        const size_t end = align_up(payload + sizeof(Callable), alignof(header_type));
+        if (end > m_capacity || alignof(Callable) > m_alignment)
+            reallocate(std::max({end, 2 * m_capacity, min_capacity}), alignof(Callable));
+
+        auto& obj = *::new (m_data + payload) Callable{std::forward<CallableArgs>(args)...};
+        ::new (m_data + m_size) header_type{
+            &vtable,
+            static_cast<uint32_t>(payload - m_size),
+            static_cast<uint32_t>(end - m_size)};
+        m_size = end;
+        ++m_count;
+        m_trivially_relocatable = m_trivially_relocatable && vtable.relocate == nullptr;
+        m_trivially_destructible = m_trivially_destructible && vtable.destroy == nullptr;
+        return obj;
+    }
+
+    // Calls the stored callables in the order they were added.
+    // An rvalue reference argument refers to the same object in every call, so after a
+    // callable moves from it, the callables that follow get the moved from object.
+    template <bool C = Const, DZE_REQUIRES(C)>
+    void operator()(Args... args) const noexcept(Noexcept)
+    {
+        call_all(static_cast<arg_t<Args>>(args)...);
+    }
+
+    template <bool C = Const, DZE_REQUIRES(!C)>
+    void operator()(Args... args) noexcept(Noexcept)
+    {
+        call_all(static_cast<arg_t<Args>>(args)...);
+    }
+
+    // Callables of signatures that are not const are only called through a vector that is
+    // not const.
+    [[nodiscard]] iterator begin() noexcept { return iterator{m_data}; }
+
+    [[nodiscard]] iterator end() noexcept { return iterator{m_data + m_size}; }
+
+    template <bool C = Const, DZE_REQUIRES(C)>
+    [[nodiscard]] iterator begin() const noexcept
+    {
+        return iterator{m_data};
+    }
+
+    template <bool C = Const, DZE_REQUIRES(C)>
+    [[nodiscard]] iterator end() const noexcept
+    {
+        return iterator{m_data + m_size};
+    }
+
+    // Destroys the callables and keeps the buffer.
+    void clear() noexcept
+    {
+        if (!m_trivially_destructible)
+        {
+            for_each_entry([this] (const header_type& entry, size_t, const size_t payload)
+            {
+                if (entry.vtable->destroy != nullptr)
+                    entry.vtable->destroy(m_data + payload);
+            });
+        }
+        m_size = 0;
+        m_count = 0;
+        m_trivially_relocatable = true;
+        m_trivially_destructible = true;
+    }
+
+    // Makes sure that callables can be added without reallocating until size_bytes()
+    // reaches bytes.
+    void reserve_bytes(const size_type bytes)
+    {
+        if (bytes > m_capacity)
+            reallocate(bytes, m_alignment);
+    }
+
+    [[nodiscard]] size_type size() const noexcept { return m_count; }
+
+    [[nodiscard]] bool empty() const noexcept { return m_count == 0; }
+
+    // Number of bytes used by the entries, including their headers and padding.
+    [[nodiscard]] size_type size_bytes() const noexcept { return m_size; }
+
+    [[nodiscard]] size_type capacity_bytes() const noexcept { return m_capacity; }
+
+    [[nodiscard]] allocator_type get_allocator() const noexcept { return *this; }
+
+private:
+    std::byte* m_data = nullptr;
+    size_t m_size = 0;
+    size_t m_capacity = 0;
+    size_t m_alignment = default_alignment;
+    size_t m_count = 0;
+    bool m_trivially_relocatable = true;
+    bool m_trivially_destructible = true;
+
+    [[nodiscard]] Alloc& allocator() noexcept { return *this; }
+
+    [[nodiscard]] const header_type& header(const size_t offset) const noexcept
+    {
+        return *reinterpret_cast<const header_type*>(m_data + offset);
+    }
+
+    // Calls f with the header, the offset of the header and the offset of the callable of
+    // each entry.
+    template <typename F>
+    void for_each_entry(F f) const
+    {
+        const size_t size = m_size;
+        for (size_t offset = 0; offset != size;)
+        {
+            const auto& entry = header(offset);
+            const size_t payload = offset + entry.payload;
+            const size_t next = offset + entry.size;
+            f(entry, offset, payload);
+            offset = next;
+        }
+    }
+
+    void call_all(arg_t<Args>... args) const noexcept(Noexcept)
+    {
+        std::byte* const data = m_data;
+        for_each_entry([&] (const header_type& entry, size_t, const size_t payload)
+        {
+            // By value arguments are copied into temporaries that are passed by
+            // reference, see param_t.
+            entry.vtable->call(data + payload, static_cast<Args>(args)...);
+        });
+    }
+
+    // Moves the entries to the same offsets in data.
+    void relocate_to(std::byte* const data) noexcept
+    {
+        if (m_trivially_relocatable)
+        {
+            if (m_size != 0)
+                std::memcpy(data, m_data, m_size);
+            return;
+        }
+
+        for_each_entry(
+            [&] (const header_type& entry, const size_t offset, const size_t payload)
+            {
+                std::memcpy(data + offset, m_data + offset, sizeof(header_type));
+                if (entry.vtable->relocate != nullptr)
+                    entry.vtable->relocate(m_data + payload, data + payload);
+                else
+                {
+                    std::memcpy(
+                        data + payload, m_data + payload, entry.size - entry.payload);
+                }
+            });
+    }
+
+    void reallocate(const size_t capacity, size_t alignment)
+    {
+        alignment = std::max(m_alignment, alignment);
+        const auto data = static_cast<std::byte*>(allocator().allocate_bytes(capacity, alignment));
+        relocate_to(data);
+        deallocate();
+        m_data = data;
+        m_capacity = capacity;
+        m_alignment = alignment;
+    }
+
+    void deallocate() noexcept
+    {
+        if (m_data != nullptr)
+            allocator().deallocate_bytes(m_data, m_capacity, m_alignment);
+    }
+
+    // Pre-condition: This object has no buffer or it is deallocated.
+    void take(vector_base& other) noexcept
+    {
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+        m_capacity = std::exchange(other.m_capacity, 0);
+        m_alignment = std::exchange(other.m_alignment, default_alignment);
+        m_count = std::exchange(other.m_count, 0);
+        m_trivially_relocatable = std::exchange(other.m_trivially_relocatable, true);
+        m_trivially_destructible = std::exchange(other.m_trivially_destructible, true);
+    }
+};
+
+} // namespace details::function_ns
+
+template <typename, typename = allocator>
+class function_vector;
+
+// Sequence of callables of different types packed back to back in one buffer.
+// Each callable takes its own size plus a small header and alignment padding,
+// instead of the fixed size of function, and none of them is allocated separately.
+// The call operator invokes the callables together, in the order they were added, and
+// discards their return values. Iterating over the vector gives access to each callable and
+// its return value.
+// Callables must not throw when moved, so that growing the buffer does not throw either.
+template <bool Noexcept, typename R, typename... Args, typename Alloc>
+class function_vector<R(Args...) noexcept(Noexcept), Alloc>
+    : public details::function_ns::vector_base<Alloc, false, Noexcept, R, Args...>
+{
+    using base = details::function_ns::vector_base<Alloc, false, Noexcept, R, Args...>;
+
+public:
+    using base::base;
+};
+
+template <bool Noexcept, typename R, typename... Args, typename Alloc>
+class function_vector<R(Args...) const noexcept(Noexcept), Alloc>
+    : public details::function_ns::vector_base<Alloc, true, Noexcept, R, Args...>
+{
+    using base = details::function_ns::vector_base<Alloc, true, Noexcept, R, Args...>;
+
+public:
+    using base::base;
+};
+
+namespace pmr {
+
+template <typename Signature>
+using function_vector = ::dze::function_vector<Signature, polymorphic_allocator>;
+
+} // namespace pmr
+
+} // namespace dze
@@ -1,3 +1,12 @@
 #pragma once
 
 #include "function.hpp"
+#include "copyable_function.hpp"
+#include "function_arena.hpp"
+#include "function_batch.hpp"
+#include "function_queue.hpp"
+#include "function_ref.hpp"
+#include "function_vector.hpp"
+#include "inplace_function.hpp"
+#include "pool_allocator.hpp"
+#include "thread_pool.hpp"
@@ -0,0 +1,271 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <dze/trivially_relocatable.hpp>
+#include <dze/type_traits.hpp>
+
+#include "function.hpp"
+
+namespace dze {
+
+template <typename, size_t, size_t>
+class inplace_function;
+
+template <typename>
+struct is_inplace_function : std::false_type {};
+
+template <typename Signature, size_t Capacity, size_t Align>
+struct is_inplace_function<inplace_function<Signature, Capacity, Align>> : std::true_type {};
+
+template <typename T>
+inline constexpr bool is_inplace_function_v = is_inplace_function<T>::value;
+
+// Move-only polymorphic function wrapper that never allocates.
+// Callables are always stored in the Capacity bytes buffer of the object, aligned to Align.
+// Storing a callable that is bigger or more aligned than that, or that may throw when
+// moved, does not compile.
+// Unlike basic_function, there is no allocator and nothing records whether the callable is
+// allocated, so the object is only the buffer and the pointer to the vtable.
+// Signature is either a function type or overloads of function types.
+template <
+    typename Signature,
+    size_t Capacity = details::function_ns::default_size,
+    size_t Align = details::function_ns::default_alignment>
+class alignas(Align) inplace_function
+    : public details::function_ns::base<inplace_function<Signature, Capacity, Align>, Signature>
+{
+    using base = details::function_ns::base<inplace_function, Signature>;
+
+    static_assert(
+        Align != 0 && (Align & (Align - 1)) == 0, "Alignment must be a power of two.");
+
+    template <typename Sig>
+    static constexpr bool is_movable_v =
+        details::function_ns::is_adoptable_signature_v<Sig, Signature>;
+
+    template <typename T, typename... Args>
+    static constexpr bool is_emplaceable_v =
+        std::is_same_v<T, std::decay_t<T>> && !is_inplace_function_v<T> &&
+        !is_function_v<T> && std::is_move_constructible_v<T> &&
+        std::is_constructible_v<T, Args...> &&
+        base::template is_convertible_v<T>;
+
+public:
+    // The buffer is zero-filled by every constructor, like the inline buffer of
+    // basic_function, because relocation copies all of it even when the callable is
+    // smaller.
+    inplace_function() noexcept
+        : m_buffer{}
+    {
+        m_delegate.reset();
+    }
+
+    inplace_function(std::nullptr_t) noexcept
+        : inplace_function{} {}
+
+    template <typename Callable,
+        DZE_REQUIRES(is_emplaceable_v<Callable, Callable&&>)>
+    inplace_function(Callable call) noexcept(std::is_nothrow_move_constructible_v<Callable>)
+        : inplace_function{}
+    {
+        emplace_impl<Callable>(std::move(call));
+    }
+
+    // Constructs a T from args directly in the buffer.
+    template <typename T, typename... Args,
+        DZE_REQUIRES(is_emplaceable_v<T, Args...>)>
+    explicit inplace_function(std::in_place_type_t<T>, Args&&... args)
+        noexcept(std::is_nothrow_constructible_v<T, Args...>)
+        : inplace_function{}
+    {
+        emplace_impl<T>(std::forward<Args>(args)...);
+    }
+
+    inplace_function(const inplace_function&) = delete;
+    inplace_function& operator=(const inplace_function&) = delete;
+
+    inplace_function(inplace_function&& other) noexcept
+        : m_buffer{}
+        , m_delegate{other.m_delegate}
+    {
+        take_buffer(other);
+    }
+
+    // Takes over the callable of other, whose buffer must fit in this one.
+    template <
+        typename Signature2,
+        size_t Capacity2,
+        size_t Align2,
+        DZE_REQUIRES(
+            is_movable_v<Signature2> && Capacity2 <= Capacity && Align2 <= Align &&
+            !(Capacity2 == Capacity && Align2 == Align &&
+                std::is_same_v<Signature2, Signature>))>
+    inplace_function(inplace_function<Signature2, Capacity2, Align2>&& other) noexcept
+        : m_buffer{}
+        , m_delegate{other.m_delegate}
+    {
+        take_buffer(other);
+    }
+
+    inplace_function& operator=(inplace_function&& other) noexcept
+    {
+        if (this != &other)
+        {
+            m_delegate.destroy(m_buffer);
+            m_delegate = other.m_delegate;
+            take_buffer(other);
+        }
+        return *this;
+    }
+
+    ~inplace_function() { m_delegate.destroy(m_buffer); }
+
+    void swap(inplace_function& other) noexcept
+    {
+        inplace_function temp{std::move(other)};
+        other = std::move(*this);
+        *this = std::move(temp);
+    }
+
+    inplace_function& operator=(std::nullptr_t) noexcept
+    {
+        m_delegate.destroy(m_buffer);
+        m_delegate.reset();
+        return *this;
+    }
+
+    template <typename Callable,
+        DZE_REQUIRES(is_emplaceable_v<Callable, Callable&&>)>
+    inplace_function& operator=(Callable call)
+        noexcept(std::is_nothrow_move_constructible_v<Callable>)
+    {
+        emplace_impl<Callable>(std::move(call));
+        return *this;
+    }
+
+    // Destroys the stored callable, if any, then constructs a T from args directly in the
+    // buffer. If that throws, this object is left empty.
+    template <typename T, typename... Args,
+        DZE_REQUIRES(is_emplaceable_v<T, Args...>)>
+    T& emplace(Args&&... args) noexcept(std::is_nothrow_constructible_v<T, Args...>)
+    {
+        return emplace_impl<T>(std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const noexcept { return !m_delegate.empty(); }
+
+    // True if this object can be relocated by copying its bytes, which is the case if it
+    // is empty or its callable is trivially relocatable. See uninitialized_relocate.
+    [[nodiscard]] bool trivially_relocatable() const noexcept
+    {
+        return m_delegate.trivially_movable();
+    }
+
+    [[nodiscard]] static constexpr size_t capacity() noexcept { return Capacity; }
+
+    // Returns the stored callable if it is a T, otherwise null. See call_if.
+    template <typename T>
+    [[nodiscard]] T* target() noexcept
+    {
+        return m_delegate.template holds<T>() ? static_cast<T*>(call_addr()) : nullptr;
+    }
+
+    template <typename T>
+    [[nodiscard]] const T* target() const noexcept
+    {
+        return m_delegate.template holds<T>() ? static_cast<const T*>(call_addr()) : nullptr;
+    }
+
+private:
+    using delegate_type = typename base::delegate_type;
+
+    friend base;
+
+    template <typename, size_t, size_t>
+    friend class inplace_function;
+
+    template <typename, typename>
+    friend struct function_fits_inline;
+
+    template <typename, size_t, typename>
+    friend class details::function_ns::overload;
+
+    friend struct details::function_ns::batch_access;
+
+    friend bool operator==(const inplace_function& f, std::nullptr_t) noexcept
+    {
+        return !f;
+    }
+
+    friend bool operator==(std::nullptr_t, const inplace_function& f) noexcept
+    {
+        return !f;
+    }
+
+    friend bool operator!=(const inplace_function& f, std::nullptr_t) noexcept
+    {
+        return static_cast<bool>(f);
+    }
+
+    friend bool operator!=(std::nullptr_t, const inplace_function& f) noexcept
+    {
+        return static_cast<bool>(f);
+    }
+
+    // The buffer must be the first member to be aligned to Align.
+    alignas(Align) std::byte m_buffer[Capacity];
+    delegate_type m_delegate;
+
+    template <typename T>
+    static constexpr bool is_stored_inline_v =
+        sizeof(T) <= Capacity && alignof(T) <= Align &&
+        (is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>);
+
+    template <typename T, typename... Args>
+    T& emplace_impl(Args&&... args) noexcept(std::is_nothrow_constructible_v<T, Args...>)
+    {
+        static_assert(
+            sizeof(T) <= Capacity,
+            "The callable does not fit in the buffer of the inplace_function.");
+        static_assert(
+            alignof(T) <= Align,
+            "The callable is more aligned than the buffer of the inplace_function.");
+        static_assert(
+            is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>,
+            "Moving the callable may throw, but moving an inplace_function must not.");
+
+        m_delegate.destroy(m_buffer);
+        m_delegate.reset();
+        auto& result = *::new (m_buffer) T(std::forward<Args>(args)...);
+        m_delegate.template set<T, base::is_const, false, false>();
+        return result;
+    }
+
+    // Relocates the callable of other, if any, to the buffer of this object and leaves
+    // other empty. Nothing is copied if other is empty.
+    template <typename Signature2, size_t Capacity2, size_t Align2>
+    void take_buffer(inplace_function<Signature2, Capacity2, Align2>& other) noexcept
+    {
+        if (other.m_delegate.empty())
+            return;
+
+        other.m_delegate.relocate(other.m_buffer, m_buffer, Capacity2);
+        other.m_delegate.reset();
+    }
+
+    [[nodiscard]] const void* call_addr() const noexcept { return m_buffer; }
+
+    [[nodiscard]] void* call_addr() noexcept { return m_buffer; }
+};
+
+// Callables that inplace_function cannot store do not compile instead.
+template <typename Signature, size_t Capacity, size_t Align, typename Callable>
+struct function_fits_inline<inplace_function<Signature, Capacity, Align>, Callable>
+    : std::bool_constant<inplace_function<Signature, Capacity, Align>::template
+        is_stored_inline_v<std::decay_t<Callable>>> {};
+
+} // namespace dze
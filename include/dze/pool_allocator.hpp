@@ -0,0 +1,209 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+#include <dze/allocator.hpp>
+
+namespace dze {
+
+namespace details::function_ns {
+
+// Set when the cache of the thread is destroyed. Being trivially destructible, it can
+// still be read after that, until the thread ends.
+inline thread_local bool thread_pool_cache_destroyed = false;
+
+// Caches the blocks freed by a thread in free lists, one for each size and alignment
+// class, and gives them back to allocator when the thread exits.
+// The classes cover the callables that spill out of the inline buffer of function.
+// Pooled blocks always have the size and alignment of their class, whether they come
+// from a cache or not, so any thread can cache them.
+class pool_cache
+{
+    struct node
+    {
+        node* next;
+    };
+
+    struct free_list
+    {
+        node* head = nullptr;
+        size_t count = 0;
+    };
+
+public:
+    static constexpr size_t granularity = 16;
+    static constexpr size_t max_size = 512;
+    static constexpr size_t max_alignment = 64;
+    // Per class, more freed blocks are given back to allocator right away.
+    static constexpr size_t max_cached = 256;
+
+    pool_cache() = default;
+    pool_cache(const pool_cache&) = delete;
+    pool_cache& operator=(const pool_cache&) = delete;
+
+    ~pool_cache()
+    {
+        thread_pool_cache_destroyed = true;
+        for (size_t a = 0; a != alignment_classes; ++a)
+        {
+            for (size_t s = 0; s != size_classes; ++s)
+            {
+                for (auto* n = m_lists[a][s].head; n;)
+                {
+                    auto* const next = n->next;
+                    allocator{}.deallocate_bytes(n, class_size(s), class_alignment(a));
+                    n = next;
+                }
+            }
+        }
+    }
+
+    // Returns the cache of the calling thread, or null once it is destroyed.
+    // The cache of the main thread is destroyed before the objects with static storage
+    // duration, so functions of those free their blocks without it.
+    [[nodiscard]] static pool_cache* local() noexcept;
+
+    [[nodiscard]] static constexpr bool pooled(
+        const size_t size, const size_t alignment) noexcept
+    {
+        return size <= max_size && alignment <= max_alignment;
+    }
+
+    // Pre-condition: pooled(size, alignment)
+    [[nodiscard]] void* allocate(const size_t size, const size_t alignment)
+        noexcept(noexcept(allocator{}.allocate_bytes(size, alignment)))
+    {
+        const size_t s = size_class(size);
+        const size_t a = alignment_class(alignment);
+        auto& list = m_lists[a][s];
+        if (!list.head)
+            return allocate_uncached(size, alignment);
+
+        auto* const n = list.head;
+        list.head = n->next;
+        --list.count;
+        return n;
+    }
+
+    // Pre-condition: pooled(size, alignment)
+    void deallocate(void* const p, const size_t size, const size_t alignment) noexcept
+    {
+        const size_t s = size_class(size);
+        const size_t a = alignment_class(alignment);
+        auto& list = m_lists[a][s];
+        if (list.count == max_cached)
+        {
+            deallocate_uncached(p, size, alignment);
+            return;
+        }
+
+        list.head = ::new (p) node{list.head};
+        ++list.count;
+    }
+
+    // Pre-condition: pooled(size, alignment)
+    [[nodiscard]] static void* allocate_uncached(const size_t size, const size_t alignment)
+        noexcept(noexcept(allocator{}.allocate_bytes(size, alignment)))
+    {
+        return allocator{}.allocate_bytes(
+            class_size(size_class(size)), class_alignment(alignment_class(alignment)));
+    }
+
+    // Pre-condition: pooled(size, alignment)
+    static void deallocate_uncached(void* const p, const size_t size, const size_t alignment)
+        noexcept
+    {
+        allocator{}.deallocate_bytes(
+            p, class_size(size_class(size)), class_alignment(alignment_class(alignment)));
+    }
+
+private:
+    static constexpr size_t size_classes = max_size / granularity;
+    // 16, 32 and 64.
+    static constexpr size_t alignment_classes = 3;
+
+    free_list m_lists[alignment_classes][size_classes];
+
+    [[nodiscard]] static constexpr size_t size_class(const size_t size) noexcept
+    {
+        return size == 0 ? 0 : (size - 1) / granularity;
+    }
+
+    [[nodiscard]] static constexpr size_t class_size(const size_t size_class) noexcept
+    {
+        return (size_class + 1) * granularity;
+    }
+
+    [[nodiscard]] static constexpr size_t alignment_class(const size_t alignment) noexcept
+    {
+        return alignment <= 16 ? 0 : alignment <= 32 ? 1 : 2;
+    }
+
+    [[nodiscard]] static constexpr size_t class_alignment(const size_t alignment_class)
+        noexcept
+    {
+        return size_t{16} << alignment_class;
+    }
+};
+
+inline thread_local pool_cache thread_pool_cache;
+
+inline pool_cache* pool_cache::local() noexcept
+{
+    return thread_pool_cache_destroyed ? nullptr : &thread_pool_cache;
+}
+
+} // namespace details::function_ns
+
+// Allocator for the callables that do not fit inline.
+// Blocks up to pool_cache::max_size bytes and pool_cache::max_alignment alignment are
+// rounded up to a size and alignment class and cached by the thread that frees them,
+// so steady allocation patterns stop reaching the general allocator. Other blocks come
+// straight from allocator.
+// All instances are equal and a block may be freed by another thread than the one that
+// allocated it, so functions move their allocations like with allocator.
+class pool_allocator
+{
+    using cache = details::function_ns::pool_cache;
+
+public:
+    using value_type = std::byte;
+    using is_always_equal = std::true_type;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    [[nodiscard]] void* allocate_bytes(const size_t size, const size_t alignment) const
+        noexcept(noexcept(allocator{}.allocate_bytes(size, alignment)))
+    {
+        if (cache::pooled(size, alignment))
+        {
+            if (auto* const local = cache::local())
+                return local->allocate(size, alignment);
+
+            return cache::allocate_uncached(size, alignment);
+        }
+
+        return allocator{}.allocate_bytes(size, alignment);
+    }
+
+    void deallocate_bytes(void* const p, const size_t size, const size_t alignment) const
+        noexcept
+    {
+        if (cache::pooled(size, alignment))
+        {
+            if (auto* const local = cache::local())
+                local->deallocate(p, size, alignment);
+            else
+                cache::deallocate_uncached(p, size, alignment);
+        }
+        else
+            allocator{}.deallocate_bytes(p, size, alignment);
+    }
+
+    friend bool operator==(pool_allocator, pool_allocator) noexcept { return true; }
+    friend bool operator!=(pool_allocator, pool_allocator) noexcept { return false; }
+};
+
+} // namespace dze
@@ -0,0 +1,266 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <dze/allocator.hpp>
+#include <dze/memory_resource.hpp>
+#include <dze/type_traits.hpp>
+
+#include "details/function/work_stealing_deque.hpp"
+#include "function.hpp"
+#include "function_queue.hpp"
+
+namespace dze {
+
+namespace details::function_ns {
+
+// Set on the threads of a pool, so that tasks submitted from a task go to the deque of
+// the worker running it.
+struct worker_context
+{
+    const void* pool = nullptr;
+    size_t index = 0;
+};
+
+inline thread_local worker_context current_worker;
+
+} // namespace details::function_ns
+
+// Work stealing thread pool.
+// Each worker has its own deque. Tasks submitted from a worker are pushed to its deque
+// and popped in LIFO order, which keeps fork/join work on the same core. Tasks submitted
+// from other threads go to a shared injection queue. Workers with nothing to do steal
+// from the deques of others, starting from a random victim, and sleep when no work is
+// left anywhere.
+// Tasks are stored in function<void() noexcept, Alloc>, and the allocator passed to
+// submit is used for tasks too big to be stored inline.
+template <typename Alloc = allocator>
+class thread_pool
+{
+public:
+    using task_type = function<void() noexcept, Alloc>;
+    using allocator_type = Alloc;
+
+    // The capacities are rounded up to powers of two. A worker pushes to the injection
+    // queue when its deque is full.
+    explicit thread_pool(
+        const size_t threads = default_thread_count(),
+        const size_t deque_capacity = 256,
+        const size_t injection_capacity = 4096)
+        : m_injection{injection_capacity}
+    {
+        m_workers.reserve(threads);
+        for (size_t i = 0; i != threads; ++i)
+            m_workers.push_back(std::make_unique<worker>(deque_capacity, i));
+
+        try
+        {
+            for (size_t i = 0; i != threads; ++i)
+                m_workers[i]->thread = std::thread{[this, i] { run(i); }};
+        }
+        catch (...)
+        {
+            stop();
+            throw;
+        }
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    // Runs the tasks left, including the ones they submit, then joins the workers.
+    // Pre-condition: No other thread submits tasks.
+    ~thread_pool() { stop(); }
+
+    // Pre-condition: The pool is not being destroyed, unless this is called from a task.
+    template <typename Callable,
+        DZE_REQUIRES(std::is_nothrow_invocable_v<std::decay_t<Callable>&>)>
+    void submit(Callable&& call, const Alloc& alloc = Alloc{})
+    {
+        push(task_type{std::forward<Callable>(call), alloc});
+    }
+
+    [[nodiscard]] size_t thread_count() const noexcept { return m_workers.size(); }
+
+    [[nodiscard]] static size_t default_thread_count() noexcept
+    {
+        return std::max(size_t{1}, size_t{std::thread::hardware_concurrency()});
+    }
+
+private:
+    struct worker
+    {
+        details::function_ns::work_stealing_deque<task_type> deque;
+        std::uint32_t seed;
+        std::thread thread;
+
+        worker(const size_t capacity, const size_t index)
+            : deque{capacity}
+            , seed{static_cast<std::uint32_t>(index) * 2654435761U + 1} {}
+    };
+
+    function_queue<task_type> m_injection;
+    std::vector<std::unique_ptr<worker>> m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::atomic<size_t> m_sleeping{0};
+    // Guarded by m_mutex.
+    bool m_stopping = false;
+
+    [[nodiscard]] worker* local_worker() const noexcept
+    {
+        const auto& context = details::function_ns::current_worker;
+        return context.pool == this ? m_workers[context.index].get() : nullptr;
+    }
+
+    void push(task_type&& task) noexcept
+    {
+        auto* const self = local_worker();
+        if (!self || !self->deque.push(std::move(task)))
+        {
+            while (!m_injection.try_push(std::move(task)))
+            {
+                // Waiting for other workers could dead lock when all of them are pushing.
+                if (self)
+                {
+                    task();
+                    return;
+                }
+
+                std::this_thread::yield();
+            }
+        }
+
+        // Pairs with the fence in park, either the sleeping worker is seen or it sees the
+        // task.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_sleeping.load(std::memory_order_relaxed) != 0)
+        {
+            std::lock_guard lock{m_mutex};
+            m_wake.notify_one();
+        }
+    }
+
+    void run(const size_t index) noexcept
+    {
+        details::function_ns::current_worker = {this, index};
+        auto& self = *m_workers[index];
+
+        // Going to sleep and waking up is costly for the submitting thread too, so look
+        // for work a few more times first.
+        constexpr int spins = 16;
+        int misses = 0;
+        for (;;)
+        {
+            if (auto task = find_task(self, index))
+            {
+                (*task)();
+                misses = 0;
+            }
+            else if (++misses < spins)
+                std::this_thread::yield();
+            else if (park())
+                misses = 0;
+            else
+                return;
+        }
+    }
+
+    [[nodiscard]] std::optional<task_type> find_task(worker& self, const size_t index) noexcept
+    {
+        if (auto task = self.deque.pop())
+            return task;
+
+        if (auto task = m_injection.try_pop())
+            return task;
+
+        const size_t count = m_workers.size();
+        if (count == 1)
+            return std::nullopt;
+
+        // xorshift32
+        self.seed ^= self.seed << 13;
+        self.seed ^= self.seed >> 17;
+        self.seed ^= self.seed << 5;
+
+        const size_t start = self.seed % count;
+        for (size_t i = 0; i != count; ++i)
+        {
+            const size_t victim = (start + i) % count;
+            if (victim == index)
+                continue;
+
+            if (auto task = m_workers[victim]->deque.steal())
+                return task;
+        }
+
+        return std::nullopt;
+    }
+
+    [[nodiscard]] bool has_work() const noexcept
+    {
+        return !m_injection.empty() ||
+            std::any_of(
+                m_workers.begin(),
+                m_workers.end(),
+                [] (const auto& w) { return !w->deque.empty(); });
+    }
+
+    // Returns false when the pool is stopping and no work is left.
+    [[nodiscard]] bool park() noexcept
+    {
+        std::unique_lock lock{m_mutex};
+        m_sleeping.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        bool result = true;
+        while (!has_work())
+        {
+            if (m_stopping)
+            {
+                result = false;
+                break;
+            }
+
+            m_wake.wait(lock);
+        }
+
+        m_sleeping.fetch_sub(1, std::memory_order_relaxed);
+        return result;
+    }
+
+    void stop() noexcept
+    {
+        {
+            std::lock_guard lock{m_mutex};
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+
+        for (auto& w : m_workers)
+        {
+            if (w->thread.joinable())
+                w->thread.join();
+        }
+    }
+};
+
+namespace pmr {
+
+using thread_pool = ::dze::thread_pool<polymorphic_allocator>;
+
+} // namespace pmr
+
+} // namespace dze
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace dze {
+
+// A type is trivially relocatable if moving an object to a new address and destroying
+// the source is equivalent to copying its bytes and forgetting the source.
+// Specialize this for types that are trivially relocatable but not trivially copyable.
+// Types whose objects are trivially relocatable depending on their value, like function,
+// tell it with a trivially_relocatable() member function instead, see
+// uninitialized_relocate.
+template <typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+namespace details::function_ns {
+
+template <typename T, typename = void>
+struct has_trivially_relocatable_member : std::false_type {};
+
+template <typename T>
+struct has_trivially_relocatable_member<
+    T,
+    std::void_t<decltype(std::declval<const T&>().trivially_relocatable())>>
+    : std::true_type {};
+
+template <typename T>
+[[nodiscard]] bool relocatable_by_copy(const T& obj) noexcept
+{
+    if constexpr (has_trivially_relocatable_member<T>::value)
+        return obj.trivially_relocatable();
+    else
+        return false;
+}
+
+template <typename T>
+void copy_objects(T* const to, const T* const from, const size_t count) noexcept
+{
+    if (count != 0)
+    {
+        std::memmove(
+            static_cast<void*>(to), static_cast<const void*>(from), count * sizeof(T));
+    }
+}
+
+template <typename T>
+void relocate_object(T* const from, T* const to) noexcept
+{
+    ::new (static_cast<void*>(to)) T{std::move(*from)};
+    from->~T();
+}
+
+} // namespace details::function_ns
+
+// Moves the objects of [first, last) to the uninitialized memory at result and destroys
+// them. Runs of objects that are trivially relocatable are copied at once.
+// The ranges may overlap if result is before first.
+// Returns the end of the relocated objects.
+template <typename T>
+T* uninitialized_relocate(T* first, T* const last, T* result) noexcept
+{
+    using namespace details::function_ns;
+
+    static_assert(
+        is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>,
+        "Relocation must not throw.");
+
+    if constexpr (is_trivially_relocatable_v<T>)
+    {
+        copy_objects(result, first, static_cast<size_t>(last - first));
+        return result + (last - first);
+    }
+    else
+    {
+        while (first != last)
+        {
+            T* run_last = first;
+            while (run_last != last && relocatable_by_copy(*run_last))
+                ++run_last;
+
+            copy_objects(result, first, static_cast<size_t>(run_last - first));
+            result += run_last - first;
+            first = run_last;
+            if (first != last)
+                relocate_object(first++, result++);
+        }
+        return result;
+    }
+}
+
+// Same as uninitialized_relocate, from the last object to the first, so that the ranges
+// may overlap if d_last is after last.
+// Returns the beginning of the relocated objects.
+template <typename T>
+T* uninitialized_relocate_backward(T* const first, T* last, T* d_last) noexcept
+{
+    using namespace details::function_ns;
+
+    static_assert(
+        is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>,
+        "Relocation must not throw.");
+
+    if constexpr (is_trivially_relocatable_v<T>)
+    {
+        d_last -= last - first;
+        copy_objects(d_last, first, static_cast<size_t>(last - first));
+        return d_last;
+    }
+    else
+    {
+        while (last != first)
+        {
+            T* run_first = last;
+            while (run_first != first && relocatable_by_copy(*(run_first - 1)))
+                --run_first;
+
+            d_last -= last - run_first;
+            copy_objects(d_last, run_first, static_cast<size_t>(last - run_first));
+            last = run_first;
+            if (last != first)
+                relocate_object(--last, --d_last);
+        }
+        return d_last;
+    }
+}
+
+} // namespace dze
@@ -0,0 +1,217 @@
+#include <dze/functional.hpp>
+
+#include <array>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+
+#include <catch2/catch.hpp>
+
+namespace {
+
+struct lifetime_counter
+{
+    int live = 0;
+    int copies = 0;
+};
+
+template <size_t Size>
+struct copy_counted_callable
+{
+    lifetime_counter* counter;
+    std::array<std::byte, Size> padding = {};
+
+    explicit copy_counted_callable(lifetime_counter& c) noexcept
+        : counter{&c}
+    {
+        ++counter->live;
+    }
+
+    copy_counted_callable(const copy_counted_callable& other) noexcept
+        : counter{other.counter}
+    {
+        ++counter->live;
+        ++counter->copies;
+    }
+
+    copy_counted_callable(copy_counted_callable&& other) noexcept
+        : counter{other.counter}
+    {
+        ++counter->live;
+    }
+
+    copy_counted_callable& operator=(const copy_counted_callable&) = delete;
+    copy_counted_callable& operator=(copy_counted_callable&&) = delete;
+
+    ~copy_counted_callable() { --counter->live; }
+
+    int operator()() const { return counter->live; }
+};
+
+template <template <typename...> typename Function>
+void test_copy_state()
+{
+    Function<int()> f = [i = 0] () mutable { return ++i; };
+    CHECK(f() == 1);
+
+    auto g = f;
+    CHECK(f() == 2);
+    CHECK(g() == 2);
+    CHECK(g() == 3);
+
+    std::array<int, 64> big{};
+    Function<int()> h = [i = 0, big] () mutable { return ++i + big[0]; };
+    CHECK(h() == 1);
+    g = h;
+    CHECK(g() == 2);
+    CHECK(h() == 2);
+
+    const auto& self = g;
+    g = self;
+    CHECK(g() == 3);
+
+    Function<int()> e;
+    g = e;
+    CHECK(!g);
+    CHECK(g == nullptr);
+}
+
+template <template <typename...> typename Function, typename Callable>
+void test_copy_lifetimes()
+{
+    lifetime_counter counter;
+    {
+        Function<int()> f1 = Callable{counter};
+        CHECK(counter.live == 1);
+
+        counter.copies = 0;
+        Function<int()> f2 = f1;
+        CHECK(counter.live == 2);
+        CHECK(counter.copies == 1);
+
+        Function<int()> f3 = std::move(f2);
+        CHECK(!f2);
+        CHECK(counter.live == 2);
+
+        f2 = f3;
+        f3 = f1;
+        f1 = nullptr;
+        CHECK(counter.live == 2);
+        CHECK(f2() == 2);
+
+        f1.swap(f2);
+        CHECK(f1() == 2);
+    }
+    CHECK(counter.live == 0);
+}
+
+} // namespace
+
+TEST_CASE("Copyable function traits")
+{
+    using copyable = dze::copyable_function<int()>;
+
+    STATIC_REQUIRE(sizeof(copyable) == sizeof(dze::function<int()>));
+    STATIC_REQUIRE(sizeof(dze::pmr::copyable_function<int()>) ==
+        sizeof(dze::pmr::function<int()>));
+    STATIC_REQUIRE(dze::is_copyable_function_v<copyable>);
+    STATIC_REQUIRE(!dze::is_copyable_function_v<dze::function<int()>>);
+    STATIC_REQUIRE(!dze::is_function_v<copyable>);
+
+    STATIC_REQUIRE(std::is_copy_constructible_v<copyable>);
+    STATIC_REQUIRE(std::is_copy_assignable_v<copyable>);
+    STATIC_REQUIRE(std::is_nothrow_move_constructible_v<copyable>);
+
+    auto move_only = [p = std::unique_ptr<int>{}] { return 0; };
+    STATIC_REQUIRE(!std::is_constructible_v<copyable, decltype(move_only)>);
+    STATIC_REQUIRE(!std::is_assignable_v<copyable&, decltype(move_only)>);
+    STATIC_REQUIRE(!std::is_constructible_v<copyable, dze::function<int()>>);
+
+    STATIC_REQUIRE(std::is_constructible_v<
+        dze::copyable_function<int()>, const dze::copyable_function<int() const>&>);
+    STATIC_REQUIRE(!std::is_constructible_v<
+        dze::copyable_function<int() const>, const dze::copyable_function<int()>&>);
+    STATIC_REQUIRE(std::is_constructible_v<
+        dze::copyable_function<long()>, const dze::copyable_function<int()>&>);
+}
+
+TEST_CASE("Copyable function copy")
+{
+    using function = dze::copyable_function<int()>;
+    STATIC_REQUIRE(
+        std::is_same_v<
+            decltype(std::declval<function&>() = std::declval<const function&>()),
+            function&>);
+    STATIC_REQUIRE(
+        std::is_same_v<decltype(std::declval<function&>() = function{}), function&>);
+    STATIC_REQUIRE(
+        std::is_same_v<decltype(std::declval<function&>() = nullptr), function&>);
+
+    test_copy_state<dze::copyable_function>();
+    test_copy_state<dze::pmr::copyable_function>();
+}
+
+TEST_CASE("Copyable function lifetimes")
+{
+    test_copy_lifetimes<dze::copyable_function, copy_counted_callable<8>>();
+    test_copy_lifetimes<dze::pmr::copyable_function, copy_counted_callable<8>>();
+    test_copy_lifetimes<dze::copyable_function, copy_counted_callable<128>>();
+    test_copy_lifetimes<dze::pmr::copyable_function, copy_counted_callable<128>>();
+}
+
+TEST_CASE("Copyable function inline copy does not allocate")
+{
+    std::array<std::byte, dze::details::function_ns::default_size> padding{};
+    padding[0] = std::byte{1};
+    dze::pmr::copyable_function<int()> f{
+        [padding] { return static_cast<int>(padding[0]); }, std::pmr::null_memory_resource()};
+
+    dze::pmr::copyable_function<int()> g{f, std::pmr::null_memory_resource()};
+    CHECK(g() == 1);
+
+    dze::pmr::copyable_function<int()> h{std::pmr::null_memory_resource()};
+    h = g;
+    CHECK(h() == 1);
+}
+
+TEST_CASE("Copyable function copy of an empty object")
+{
+    std::array<int, 64> big{};
+    dze::copyable_function<int()> f = [big] { return big[0]; };
+    f = nullptr;
+    CHECK(!f.is_inline());
+
+    dze::copyable_function<int()> g = f;
+    CHECK(!g);
+    CHECK(g.is_inline());
+
+    dze::copyable_function<int()> h = [] { return 1; };
+    h = f;
+    CHECK(!h);
+
+    const dze::copyable_function<int()> e;
+    dze::copyable_function<int()> i = e;
+    CHECK(!i);
+}
+
+TEST_CASE("Copyable function conversion")
+{
+    const dze::copyable_function<int() const> f = [] { return 1; };
+    dze::copyable_function<int()> g = f;
+    CHECK(g() == 1);
+    CHECK(f() == 1);
+
+    dze::copyable_function<long()> h = g;
+    CHECK(h() == 1);
+    CHECK(g() == 1);
+
+    dze::copyable_function<int()> i = std::move(g);
+    CHECK(!g);
+    CHECK(i() == 1);
+
+    dze::function_ref<int()> r = i;
+    CHECK(r() == 1);
+
+    dze::copyable_function deduced = [] (int a) { return a; };
+    STATIC_REQUIRE(std::is_same_v<decltype(deduced), dze::copyable_function<int(int) const>>);
+}
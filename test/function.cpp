@@ -2,7 +2,11 @@
 
 #include <array>
 #include <cstdarg>
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <memory_resource>
+#include <string>
 
 #include <catch2/catch.hpp>
 
@@ -97,6 +101,18 @@ TEST_CASE("Traits")
 
         STATIC_REQUIRE(
             std::is_nothrow_assignable_v<dze::function<int(int)>, dze::function<int(int) const>>);
+
+        using function = dze::function<int(int)>;
+        STATIC_REQUIRE(
+            std::is_same_v<decltype(std::declval<function&>() = function{}), function&>);
+        STATIC_REQUIRE(
+            std::is_same_v<
+                decltype(std::declval<function&>() = dze::function<int(int) const>{}),
+                function&>);
+        STATIC_REQUIRE(
+            std::is_same_v<decltype(std::declval<function&>() = nullptr), function&>);
+        STATIC_REQUIRE(
+            std::is_same_v<decltype(std::declval<function&>() = std::negate<>{}), function&>);
     }
 }
 
@@ -127,10 +143,18 @@ void test_invoke_functor()
     CHECK(getter(5) == 42);
 }
 
+template <typename Signature>
+using small_function = dze::basic_function<Signature, 16, 8>;
+
+template <typename Signature>
+using big_function = dze::basic_function<Signature, 512, 64>;
+
 TEST_CASE("Invoke functor", "[invoke.functor]")
 {
     test_invoke_functor<dze::function>();
     test_invoke_functor<dze::pmr::function>();
+    test_invoke_functor<small_function>();
+    test_invoke_functor<big_function>();
 }
 
 template <template <typename...> typename Function>
@@ -295,6 +319,296 @@ TEST_CASE("Swap")
         test_swap_allocated<dze::function>();
         test_swap_allocated<dze::pmr::function>();
     }
+
+    SECTION("Custom inline size")
+    {
+        test_swap_nullptr<small_function>();
+        test_swap_inline<small_function>();
+        test_swap_allocated_and_inline<small_function>();
+        test_swap_allocated<small_function>();
+
+        test_swap_inline<big_function>();
+        test_swap_allocated<big_function>();
+    }
+}
+
+TEST_CASE("Inline storage size")
+{
+    STATIC_REQUIRE(sizeof(dze::function<void()>) == 80);
+    STATIC_REQUIRE(
+        sizeof(dze::details::function_ns::delegate_t<void(), false>) == sizeof(void*));
+    STATIC_REQUIRE(
+        std::is_base_of_v<
+            dze::basic_function<
+                void(),
+                dze::details::function_ns::default_size,
+                dze::details::function_ns::default_alignment>,
+            dze::function<void()>>);
+
+    STATIC_REQUIRE(sizeof(small_function<void()>) < sizeof(dze::function<void()>));
+    STATIC_REQUIRE(alignof(big_function<void()>) == 64);
+
+    std::array<int, 16> a;
+    for (int i = 0; i != static_cast<int>(a.size()); ++i)
+        a[i] = i;
+
+    SECTION("Fits in the bigger storage only")
+    {
+        big_function<int(int)> f1 = [a] (const int i) { return a[i]; };
+        small_function<int(int)> f2 = [a] (const int i) { return a[i]; };
+        CHECK(f1(15) == 15);
+        CHECK(f2(15) == 15);
+
+        auto f3 = std::move(f1);
+        auto f4 = std::move(f2);
+        CHECK(!f1);
+        CHECK(!f2);
+        CHECK(f3(14) == 14);
+        CHECK(f4(14) == 14);
+    }
+
+    SECTION("Conversion between sizes")
+    {
+        small_function<int(int) const> f1 = [a] (const int i) { return a[i] + 1; };
+        dze::function<int(int)> f2 = std::move(f1);
+        CHECK(f2(3) == 4);
+
+        big_function<int(int)> f3 = std::move(f2);
+        CHECK(f3(4) == 5);
+
+        f1 = [] (const int i) { return i; };
+        f3 = std::move(f1);
+        CHECK(f3(6) == 6);
+    }
+
+    SECTION("Whole buffer is usable")
+    {
+        STATIC_REQUIRE(
+            dze::details::function_ns::default_size == 80 - sizeof(void*));
+
+        std::array<std::byte, dze::details::function_ns::default_size> padding{};
+        padding.back() = std::byte{3};
+        dze::pmr::function<int()> f{
+            [padding] { return static_cast<int>(padding.back()); },
+            std::pmr::null_memory_resource()};
+        CHECK(f() == 3);
+
+        dze::pmr::function<int()> g{std::pmr::null_memory_resource()};
+        g = std::move(f);
+        CHECK(g() == 3);
+    }
+}
+
+TEST_CASE("Unequal allocators")
+{
+    std::pmr::unsynchronized_pool_resource r1;
+    std::pmr::unsynchronized_pool_resource r2;
+
+    std::array<int, 32> a{};
+    a[0] = 1;
+    dze::pmr::function<int()> f1{[a] { return a[0]; }, &r1};
+    dze::pmr::function<int()> f2{[a] { return a[0] + 1; }, &r2};
+
+    f1.swap(f2);
+    CHECK(f1() == 2);
+    CHECK(f2() == 1);
+
+    dze::pmr::function<int()> f3{&r1};
+    f3 = std::move(f2);
+    CHECK(f3() == 1);
+    CHECK(!f2);
+    f2.shrink_to_fit();
+
+    f1 = nullptr;
+    f1.swap(f3);
+    CHECK(f1() == 1);
+    CHECK(!f3);
+}
+
+namespace {
+
+// Tracks the number of live objects and the number of times the move constructor is called.
+struct lifetime_counter
+{
+    int live = 0;
+    int moves = 0;
+};
+
+template <size_t Size>
+struct counted_callable
+{
+    lifetime_counter* counter;
+    std::array<std::byte, Size> padding = {};
+
+    explicit counted_callable(lifetime_counter& c) noexcept
+        : counter{&c}
+    {
+        ++counter->live;
+    }
+
+    counted_callable(counted_callable&& other) noexcept
+        : counter{other.counter}
+    {
+        ++counter->live;
+        ++counter->moves;
+    }
+
+    counted_callable(const counted_callable&) = delete;
+    counted_callable& operator=(const counted_callable&) = delete;
+    counted_callable& operator=(counted_callable&&) = delete;
+
+    ~counted_callable() { --counter->live; }
+
+    int operator()() const { return counter->live; }
+};
+
+template <size_t Size>
+struct relocatable_callable : counted_callable<Size>
+{
+    using counted_callable<Size>::counted_callable;
+};
+
+} // namespace
+
+template <size_t Size>
+struct dze::is_trivially_relocatable<relocatable_callable<Size>> : std::true_type {};
+
+template <template <typename...> typename Function, typename Callable>
+void test_lifetimes(const bool relocated)
+{
+    lifetime_counter counter;
+    lifetime_counter counter2;
+    {
+        Function<int()> f1 = Callable{counter};
+        Function<int()> f2 = Callable{counter2};
+        Function<int()> f3 = [] { return 0; };
+        CHECK(counter.live == 1);
+
+        counter.moves = 0;
+        auto f4 = std::move(f1);
+        f1 = std::move(f4);
+        f1.swap(f2);
+        f1.swap(f2);
+        f1.swap(f3);
+        f3.swap(f1);
+        CHECK(counter.live == 1);
+        CHECK(counter2.live == 1);
+        CHECK((counter.moves == 0) == relocated);
+        CHECK(f1() == 1);
+
+        f2 = std::move(f1);
+        CHECK(counter.live == 1);
+        CHECK(counter2.live == 0);
+    }
+    CHECK(counter.live == 0);
+}
+
+TEST_CASE("Relocation")
+{
+    STATIC_REQUIRE(dze::is_trivially_relocatable_v<int*>);
+    STATIC_REQUIRE(!dze::is_trivially_relocatable_v<counted_callable<8>>);
+    STATIC_REQUIRE(dze::is_trivially_relocatable_v<relocatable_callable<8>>);
+
+    SECTION("Inline")
+    {
+        test_lifetimes<dze::function, counted_callable<8>>(false);
+        test_lifetimes<dze::pmr::function, counted_callable<8>>(false);
+        test_lifetimes<dze::function, relocatable_callable<8>>(true);
+        test_lifetimes<dze::pmr::function, relocatable_callable<8>>(true);
+    }
+
+    SECTION("Allocated")
+    {
+        test_lifetimes<dze::function, counted_callable<128>>(true);
+        test_lifetimes<dze::pmr::function, counted_callable<128>>(true);
+        test_lifetimes<dze::function, relocatable_callable<128>>(true);
+        test_lifetimes<dze::pmr::function, relocatable_callable<128>>(true);
+    }
+
+    SECTION("Inline after allocated")
+    {
+        lifetime_counter counter;
+        {
+            dze::function<int()> f1 = counted_callable<128>{counter};
+            f1 = nullptr;
+            f1.shrink_to_fit();
+            dze::function<int()> f2 = counted_callable<8>{counter};
+            f1 = std::move(f2);
+            CHECK(f1() == 1);
+        }
+        CHECK(counter.live == 0);
+    }
+
+    SECTION("Trivially copyable")
+    {
+        std::array<int, 8> a = {1, 2, 3, 4, 5, 6, 7, 8};
+        dze::function<int(size_t)> f1 = [a] (const size_t i) { return a[i]; };
+        dze::function<int(size_t)> f2 = [] (const size_t i) { return static_cast<int>(i); };
+        dze::function<int(size_t)> f3 = std::move(f1);
+        CHECK(!f1);
+        CHECK(f3(7) == 8);
+
+        f1 = std::move(f3);
+        f1.swap(f2);
+        CHECK(f1(7) == 7);
+        CHECK(f2(7) == 8);
+    }
+}
+
+TEST_CASE("Uninitialized relocation")
+{
+    using function_t = dze::function<int()>;
+
+    lifetime_counter counter;
+    std::allocator<function_t> alloc;
+    function_t* const a = alloc.allocate(8);
+    function_t* const b = alloc.allocate(8);
+    {
+        // Trivially relocatable, not trivially relocatable, allocated and empty callables.
+        ::new (a) function_t{relocatable_callable<8>{counter}};
+        ::new (a + 1) function_t{counted_callable<8>{counter}};
+        ::new (a + 2) function_t{counted_callable<128>{counter}};
+        ::new (a + 3) function_t{};
+        ::new (a + 4) function_t{counted_callable<8>{counter}};
+        CHECK(a[0].trivially_relocatable());
+        CHECK(!a[1].trivially_relocatable());
+        CHECK(a[2].trivially_relocatable());
+        CHECK(a[3].trivially_relocatable());
+        CHECK(counter.live == 4);
+
+        counter.moves = 0;
+        CHECK(dze::uninitialized_relocate(a, a + 5, b) == b + 5);
+        CHECK(counter.live == 4);
+        CHECK(counter.moves == 2);
+        CHECK(b[0]() == 4);
+        CHECK(b[2]() == 4);
+        CHECK(!b[3]);
+
+        // Makes room for one more at the front, then removes it.
+        counter.moves = 0;
+        CHECK(dze::uninitialized_relocate_backward(b, b + 5, b + 6) == b + 1);
+        ::new (b) function_t{std::in_place_type<relocatable_callable<8>>, counter};
+        CHECK(counter.live == 5);
+        CHECK(counter.moves == 2);
+        CHECK(b[5]() == 5);
+
+        b->~function_t();
+        CHECK(dze::uninitialized_relocate(b + 1, b + 6, b) == b + 5);
+        CHECK(counter.live == 4);
+        CHECK(counter.moves == 4);
+        CHECK(b[4]() == 4);
+
+        std::destroy(b, b + 5);
+        CHECK(counter.live == 0);
+    }
+    alloc.deallocate(a, 8);
+    alloc.deallocate(b, 8);
+
+    std::array<int, 4> ints = {1, 2, 3, 4};
+    std::array<int, 4> others{};
+    CHECK(dze::uninitialized_relocate(ints.data(), ints.data() + 4, others.data()) ==
+        others.data() + 4);
+    CHECK(others == ints);
 }
 
 TEST_CASE("Non-copyable lambda")
@@ -365,6 +679,121 @@ TEST_CASE("Overloaded functor")
     CHECK(variant6_const_nonconst(28, {}) == 100 + 6 * 28);
 }
 
+TEST_CASE("Overloads")
+{
+    struct visitor
+    {
+        int base;
+
+        int operator()(int x) { return base + x; }
+
+        int operator()(int x) const { return base + 2 * x; }
+
+        int operator()(const std::string& s) const noexcept
+        {
+            return base + static_cast<int>(s.size());
+        }
+
+        int operator()(int x, int y) { return base + x * y; }
+    };
+
+    using signatures = dze::overloads<
+        int(int), int(const std::string&) const noexcept, int(int, int)>;
+
+    STATIC_REQUIRE(sizeof(dze::function<signatures>) == sizeof(dze::function<void()>));
+    STATIC_REQUIRE(std::is_constructible_v<dze::function<signatures>, visitor>);
+    STATIC_REQUIRE(!std::is_constructible_v<dze::function<signatures>, int(*)(int)>);
+    STATIC_REQUIRE(!std::is_constructible_v<
+        dze::function<dze::overloads<int(int), int(int, int) const>>, visitor>);
+    STATIC_REQUIRE(std::is_nothrow_invocable_v<
+        const dze::function<signatures>&, const std::string&>);
+    STATIC_REQUIRE(!std::is_invocable_v<const dze::function<signatures>&, int>);
+
+    dze::function<signatures> f = visitor{100};
+    CHECK(f(1) == 101);
+    CHECK(f("abc") == 103);
+    CHECK(f(2, 3) == 106);
+
+    const auto& cf = f;
+    CHECK(cf("abcd") == 104);
+
+    dze::function<dze::overloads<int(int) const, int(int, int)>> g = visitor{200};
+    CHECK(g(1) == 202);
+    CHECK(g(2, 3) == 206);
+
+    auto h = std::move(f);
+    CHECK(!f);
+    CHECK(h(1) == 101);
+
+    // Callables that do not fit inline.
+    std::array<int, 32> a{};
+    a[0] = 7;
+    h = [a] (const auto&... x) noexcept { return a[0] + static_cast<int>(sizeof...(x)); };
+    CHECK(h(0) == 8);
+    CHECK(h("") == 8);
+    CHECK(h(0, 0) == 9);
+
+    // Single signature functions can be made from a function with overloads.
+    dze::function<int(int, int)> single = std::move(h);
+    CHECK(single(0, 0) == 9);
+
+    dze::copyable_function<signatures> c = visitor{300};
+    auto d = c;
+    CHECK(c(1) == 301);
+    CHECK(d("ab") == 302);
+}
+
+namespace {
+
+int add_one(const int x) { return x + 1; }
+
+long add_two(const int x) noexcept { return x + 2; }
+
+size_t take_size(std::string s) { return std::move(s).size(); }
+
+} // namespace
+
+TEST_CASE("Function pointers")
+{
+    // Called directly.
+    dze::function<int(int)> f = add_one;
+    CHECK(f(1) == 2);
+
+    dze::function<long(int) const noexcept> g = add_two;
+    CHECK(g(1) == 3);
+
+    // Called through a call stub, the types of the function pointers differ from the
+    // signatures.
+    dze::function<int(int) const> h = add_one;
+    CHECK(h(1) == 2);
+
+    dze::function<long(int)> i = add_one;
+    CHECK(i(2) == 3);
+
+    dze::function<long(int)> j = add_two;
+    CHECK(j(2) == 4);
+
+    dze::function<size_t(std::string)> k = take_size;
+    CHECK(k(std::string(32, 'a')) == 32);
+
+    auto moved = std::move(f);
+    CHECK(!f);
+    CHECK(moved(2) == 3);
+
+    f = std::move(moved);
+    dze::function_ref<int(int)> ref = f;
+    CHECK(ref(3) == 4);
+
+    dze::copyable_function<int(int)> c = add_one;
+    auto copy = c;
+    CHECK(copy(4) == 5);
+
+    // A stateless callable and a function pointer are both moved by copying their bytes.
+    dze::function<int(int)> stateless = [] (const int x) { return x + 3; };
+    f = std::move(stateless);
+    CHECK(f(1) == 4);
+}
+
 TEST_CASE("Lambda")
 {
     dze::function func_const = [] (const int x) { return 2000 + x; };
@@ -535,7 +964,7 @@ TEST_CASE("Copy and move")
 
             cmt.reset_counters();
             f(std::move(cmt));
-            CHECK(cmt.move_count() == 4);
+            CHECK(cmt.move_count() == 2);
             CHECK(cmt.copy_count() == 0);
         }
 
@@ -798,3 +1227,630 @@ TEST_CASE("Constructor with copy")
     STATIC_REQUIRE(noexcept(dze::function{lx}));
     STATIC_REQUIRE(!noexcept(dze::function{ly}));
 }
+
+namespace {
+
+struct move_counter
+{
+    int moves = 0;
+    int copies = 0;
+};
+
+template <size_t Size>
+struct counted_capture
+{
+    move_counter* counter;
+    int value;
+    std::array<std::byte, Size> padding = {};
+
+    counted_capture(move_counter& c, const int v) noexcept
+        : counter{&c}
+        , value{v} {}
+
+    counted_capture(const counted_capture& other) noexcept
+        : counter{other.counter}
+        , value{other.value}
+    {
+        ++counter->copies;
+    }
+
+    counted_capture(counted_capture&& other) noexcept
+        : counter{other.counter}
+        , value{other.value}
+    {
+        ++counter->moves;
+    }
+
+    counted_capture& operator=(const counted_capture&) = delete;
+    counted_capture& operator=(counted_capture&&) = delete;
+
+    ~counted_capture() = default;
+
+    int operator()() const { return value; }
+};
+
+struct throwing_capture
+{
+    explicit throwing_capture(const bool do_throw)
+    {
+        if (do_throw)
+            throw 0;
+    }
+
+    void operator()() const {}
+};
+
+} // namespace
+
+TEST_CASE("In place construction")
+{
+    using small = counted_capture<8>;
+    using big = counted_capture<256>;
+
+    STATIC_REQUIRE(std::is_constructible_v<
+        dze::function<int()>, std::in_place_type_t<small>, move_counter&, int>);
+    STATIC_REQUIRE(!std::is_constructible_v<
+        dze::function<int()>, std::in_place_type_t<small>, int>);
+    STATIC_REQUIRE(!std::is_constructible_v<
+        dze::function<int()>, std::in_place_type_t<const small>, move_counter&, int>);
+    STATIC_REQUIRE(!std::is_constructible_v<
+        dze::function<void()>, std::in_place_type_t<callable_but_not_copyable>>);
+    STATIC_REQUIRE(!std::is_convertible_v<std::in_place_type_t<small>, dze::function<int()>>);
+    STATIC_REQUIRE(std::is_nothrow_constructible_v<
+        dze::function<int()>, std::in_place_type_t<small>, move_counter&, int>);
+    STATIC_REQUIRE(!std::is_nothrow_constructible_v<
+        dze::function<void()>, std::in_place_type_t<throwing_capture>, bool>);
+
+    move_counter counter;
+
+    SECTION("Constructor")
+    {
+        dze::function<int()> f{std::in_place_type<small>, counter, 1};
+        dze::function<int()> g{std::in_place_type<big>, counter, 2};
+        CHECK(f() == 1);
+        CHECK(g() == 2);
+        CHECK(counter.moves == 0);
+
+        std::pmr::monotonic_buffer_resource resource;
+        dze::pmr::function<int()> h{
+            std::allocator_arg, &resource, std::in_place_type<big>, counter, 3};
+        CHECK(h() == 3);
+        CHECK(counter.moves == 0);
+    }
+
+    SECTION("Emplace")
+    {
+        dze::function<int()> f;
+        auto& s = f.emplace<small>(counter, 1);
+        CHECK(s.value == 1);
+        CHECK(f() == 1);
+
+        auto& b = f.emplace<big>(counter, 2);
+        b.value = 3;
+        CHECK(f() == 3);
+
+        // Reuses the allocation.
+        f.emplace<big>(counter, 4);
+        CHECK(f() == 4);
+        CHECK(counter.moves == 0);
+
+        dze::function<void()> g{std::in_place_type<big>, counter, 5};
+        CHECK_THROWS(g.emplace<throwing_capture>(true));
+        CHECK(!g);
+        g.emplace<throwing_capture>(false);
+        CHECK(g);
+    }
+
+    SECTION("make_function")
+    {
+        std::pmr::monotonic_buffer_resource resource;
+        auto f = dze::make_function<int(), big>(dze::polymorphic_allocator{&resource}, counter, 5);
+        STATIC_REQUIRE(std::is_same_v<decltype(f), dze::pmr::function<int()>>);
+        CHECK(f() == 5);
+        CHECK(counter.moves == 0);
+    }
+
+    SECTION("Copyable function")
+    {
+        dze::copyable_function<int()> f{std::in_place_type<big>, counter, 6};
+        CHECK(counter.moves == 0);
+
+        auto g = f;
+        CHECK(counter.copies == 1);
+        CHECK(g() == 6);
+
+        g.emplace<small>(counter, 7);
+        CHECK(g() == 7);
+        CHECK(counter.moves == 0);
+    }
+}
+
+TEST_CASE("Argument passing")
+{
+    using arg = counted_capture<16>;
+
+    move_counter counter;
+    const auto get_value = [] (const arg a) { return a.value; };
+
+    SECTION("Function reference")
+    {
+        dze::function<int(arg)> f = get_value;
+        dze::function_ref<int(arg)> ref = f;
+        CHECK(ref(arg{counter, 3}) == 3);
+        CHECK(counter.moves == 1);
+
+        dze::function_ref<int(arg) const> ref2 = get_value;
+        CHECK(ref2(arg{counter, 4}) == 4);
+        CHECK(counter.moves == 2);
+        CHECK(counter.copies == 0);
+    }
+
+    SECTION("Small trivially copyable arguments")
+    {
+        dze::function<size_t(std::array<int, 4>, int)> f =
+            [] (const std::array<int, 4> a, const int i) { return a.size() + i; };
+        CHECK(f({}, 1) == 5);
+    }
+}
+
+namespace {
+
+struct incomplete;
+
+// The argument type is incomplete where the function is declared.
+struct holds_incomplete
+{
+    dze::function<int(incomplete)> f;
+};
+
+struct incomplete
+{
+    int value;
+};
+
+} // namespace
+
+TEST_CASE("Incomplete argument types")
+{
+    holds_incomplete h;
+    CHECK(!h.f);
+
+    h.f = [] (const incomplete i) { return i.value; };
+    CHECK(h.f(incomplete{3}) == 3);
+}
+
+namespace {
+
+// Small, but moving it may throw.
+struct throwing_move_capture
+{
+    move_counter* counter;
+
+    explicit throwing_move_capture(move_counter& c) noexcept
+        : counter{&c} {}
+
+    throwing_move_capture(const throwing_move_capture& other) noexcept
+        : counter{other.counter}
+    {
+        ++counter->copies;
+    }
+
+    throwing_move_capture(throwing_move_capture&& other) noexcept(false)
+        : counter{other.counter}
+    {
+        ++counter->moves;
+    }
+
+    throwing_move_capture& operator=(const throwing_move_capture&) = delete;
+    throwing_move_capture& operator=(throwing_move_capture&&) = delete;
+
+    ~throwing_move_capture() = default;
+
+    int operator()() const { return 1; }
+};
+
+} // namespace
+
+TEST_CASE("Allocated callables")
+{
+    move_counter counter;
+
+    SECTION("Moving may throw")
+    {
+        dze::function<int()> f{std::in_place_type<throwing_move_capture>, counter};
+        STATIC_REQUIRE(std::is_nothrow_move_constructible_v<dze::function<int()>>);
+
+        auto g = std::move(f);
+        dze::function<int()> h;
+        h = std::move(g);
+        h.swap(f);
+        CHECK(f() == 1);
+        CHECK(counter.moves == 0);
+        CHECK(counter.copies == 0);
+    }
+
+    SECTION("Explicitly allocated")
+    {
+        using small = counted_capture<8>;
+
+        dze::function<int()> f{dze::allocated, small{counter, 2}};
+        CHECK(counter.moves == 1);
+
+        auto g = std::move(f);
+        dze::function<int()> h;
+        h = std::move(g);
+        CHECK(h() == 2);
+        CHECK(counter.moves == 1);
+
+        dze::function<int()> i{
+            std::allocator_arg, dze::allocator{}, dze::allocated, std::in_place_type<small>,
+            counter, 3};
+        i.swap(h);
+        CHECK(h() == 3);
+        CHECK(counter.moves == 1);
+
+        dze::copyable_function<int()> c{dze::allocated, small{counter, 4}};
+        auto d = c;
+        CHECK(counter.copies == 1);
+        auto e = std::move(d);
+        CHECK(e() == 4);
+        CHECK(counter.moves == 2);
+
+        // Inline callables are moved with the function.
+        dze::function<int()> j{std::in_place_type<small>, counter, 5};
+        auto k = std::move(j);
+        CHECK(k() == 5);
+        CHECK(counter.moves == 3);
+    }
+}
+
+namespace {
+
+// Counts the allocations made through it.
+class counting_resource : public std::pmr::memory_resource
+{
+public:
+    int allocations = 0;
+    int deallocations = 0;
+
+private:
+    void* do_allocate(const size_t bytes, const size_t alignment) override
+    {
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* const p, const size_t bytes, const size_t alignment) override
+    {
+        ++deallocations;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+int two() { return 2; }
+
+} // namespace
+
+TEST_CASE("Reserved capacity")
+{
+    counting_resource resource;
+    std::array<int, 64> a{};
+    a[1] = 1;
+    auto small = [] { return 0; };
+    auto big = [a] { return a[1]; };
+
+    SECTION("Reassignment")
+    {
+        {
+            dze::pmr::function<int()> f{&resource};
+            CHECK(f.is_inline());
+            CHECK(f.capacity() == dze::details::function_ns::default_size);
+
+            f.reserve(sizeof(big), alignof(decltype(big)));
+            CHECK(resource.allocations == 1);
+            CHECK(!f.is_inline());
+            CHECK(f.capacity() == sizeof(big));
+
+            for (int i = 0; i != 4; ++i)
+            {
+                f = small;
+                CHECK(f() == 0);
+                f = big;
+                CHECK(f() == 1);
+                f = nullptr;
+                f = &two;
+                CHECK(f() == 2);
+                CHECK(!f.is_inline());
+            }
+            CHECK(resource.allocations == 1);
+            CHECK(resource.deallocations == 0);
+
+            // Already big enough.
+            f.reserve(8);
+            CHECK(resource.allocations == 1);
+
+            f = nullptr;
+            f.shrink_to_fit();
+            CHECK(resource.deallocations == 1);
+            CHECK(f.is_inline());
+
+            f = small;
+            CHECK(f.is_inline());
+        }
+        CHECK(resource.allocations == resource.deallocations);
+    }
+
+    SECTION("Fits inline")
+    {
+        dze::pmr::function<int()> f{&resource};
+        f.reserve(16);
+        CHECK(resource.allocations == 0);
+        CHECK(f.is_inline());
+    }
+
+    SECTION("Inline callable")
+    {
+        {
+            dze::pmr::function<int()> f{small, &resource};
+            f.reserve(sizeof(big), alignof(decltype(big)));
+            CHECK(resource.allocations == 0);
+            CHECK(f.is_inline());
+            CHECK(f() == 0);
+
+            f = nullptr;
+            f.reserve(sizeof(big), alignof(decltype(big)));
+            CHECK(resource.allocations == 1);
+            CHECK(!f.is_inline());
+
+            f = big;
+            CHECK(f() == 1);
+            CHECK(resource.allocations == 1);
+        }
+        CHECK(resource.deallocations == 1);
+    }
+
+    SECTION("Growth")
+    {
+        {
+            dze::pmr::function<int()> f{big, &resource};
+            CHECK(resource.allocations == 1);
+
+            f.reserve(2 * sizeof(big), 64);
+            CHECK(resource.allocations == 2);
+            CHECK(resource.deallocations == 1);
+            CHECK(f.capacity() == 2 * sizeof(big));
+            CHECK(f() == 1);
+        }
+        CHECK(resource.deallocations == 2);
+    }
+
+    SECTION("Copyable function")
+    {
+        dze::pmr::copyable_function<int()> f{&resource};
+        f.reserve(sizeof(big));
+        f = small;
+        auto g = f;
+        CHECK(g() == 0);
+        CHECK(!f.is_inline());
+        CHECK(resource.allocations == 2);
+    }
+}
+
+TEST_CASE("Signature conversion")
+{
+    // Wrapping a function in another one would need an allocation.
+    const auto null = std::pmr::null_memory_resource();
+    std::array<int, 8> a = {1, 2, 3, 4, 5, 6, 7, 8};
+
+    SECTION("Noexcept and const")
+    {
+        dze::pmr::function<int(size_t) const noexcept> f{
+            [a] (const size_t i) noexcept { return a[i]; }, null};
+        dze::pmr::function<int(size_t) const> g{std::move(f), null};
+        CHECK(!f);
+        CHECK(g(1) == 2);
+
+        dze::pmr::function<int(size_t)> h{null};
+        h = std::move(g);
+        CHECK(!g);
+        CHECK(h(2) == 3);
+
+        dze::function_ref<int(size_t)> r = h;
+        CHECK(r(3) == 4);
+
+        dze::pmr::function<int(size_t) noexcept> i{
+            [a] (const size_t j) mutable noexcept { return ++a[j]; }, null};
+        h = std::move(i);
+        CHECK(h(0) == 2);
+        CHECK(h(0) == 3);
+
+        dze::pmr::copyable_function<int(size_t) const noexcept> c{
+            [a] (const size_t j) noexcept { return a[j]; }, null};
+        dze::pmr::copyable_function<int(size_t)> d{std::move(c), null};
+        CHECK(d(4) == 5);
+    }
+
+    SECTION("Function pointer")
+    {
+        dze::function<int(int) noexcept> f = [] (const int i) noexcept { return i + 1; };
+        dze::function<int(int)> g = std::move(f);
+        CHECK(g(1) == 2);
+
+        dze::function_ref<int(int)> r = g;
+        CHECK(r(2) == 3);
+    }
+
+    SECTION("Inline sizes")
+    {
+        small_function<int(size_t) const> f = [p = &a] (const size_t i) { return (*p)[i]; };
+        dze::function<int(size_t)> g = std::move(f);
+        CHECK(g(5) == 6);
+
+        big_function<int(size_t)> h = std::move(g);
+        CHECK(h(6) == 7);
+
+        // The inline buffer of h does not fit in g, so h is wrapped.
+        g = std::move(h);
+        CHECK(!h);
+        CHECK(g(7) == 8);
+    }
+
+    SECTION("Allocators")
+    {
+        move_counter counter;
+        std::pmr::unsynchronized_pool_resource r1;
+        std::pmr::unsynchronized_pool_resource r2;
+
+        dze::pmr::function<int() const> f{counted_capture<128>{counter, 1}, &r1};
+        CHECK(counter.moves == 1);
+
+        // The allocation is taken over.
+        dze::basic_function<int(), 512, 64, dze::polymorphic_allocator> g{std::move(f), &r1};
+        CHECK(!f);
+        CHECK(g() == 1);
+        CHECK(counter.moves == 1);
+
+        // The callable is moved to a new allocation.
+        dze::pmr::function<int()> h{std::move(g), &r2};
+        CHECK(!g);
+        CHECK(h() == 1);
+        CHECK(counter.moves == 2);
+
+        dze::function<int()> i = std::move(h);
+        CHECK(!h);
+        CHECK(i() == 1);
+        CHECK(counter.moves == 3);
+    }
+}
+
+namespace {
+
+// Callables stored inline are moved with the function, allocated ones are not.
+template <template <typename...> typename Function, size_t Size>
+bool stored_inline()
+{
+    move_counter counter;
+    Function<int()> f{std::in_place_type<counted_capture<Size>>, counter, 1};
+    auto g = std::move(f);
+    CHECK(g() == 1);
+    return counter.moves != 0;
+}
+
+} // namespace
+
+TEST_CASE("Preset layouts")
+{
+    STATIC_REQUIRE(sizeof(dze::compact_function<void()>) == 32);
+    STATIC_REQUIRE(alignof(dze::compact_function<void()>) == 32);
+    STATIC_REQUIRE(sizeof(dze::cache_line_function<void()>) == 64);
+    STATIC_REQUIRE(alignof(dze::cache_line_function<void()>) == 64);
+    STATIC_REQUIRE(sizeof(dze::large_function<void()>) == 128);
+    STATIC_REQUIRE(alignof(dze::large_function<void()>) == 64);
+    STATIC_REQUIRE(
+        sizeof(dze::cache_line_function<dze::overloads<void(), void(int)>>) == 64);
+
+    // The inline buffers are the rest of the function after the vtable pointer.
+    STATIC_REQUIRE(sizeof(counted_capture<12>) == 24);
+    CHECK(stored_inline<dze::compact_function, 12>());
+    CHECK(!stored_inline<dze::compact_function, 13>());
+    STATIC_REQUIRE(sizeof(counted_capture<44>) == 56);
+    CHECK(stored_inline<dze::cache_line_function, 44>());
+    CHECK(!stored_inline<dze::cache_line_function, 45>());
+    STATIC_REQUIRE(sizeof(counted_capture<108>) == 120);
+    CHECK(stored_inline<dze::large_function, 108>());
+    CHECK(!stored_inline<dze::large_function, 109>());
+
+    std::array<dze::cache_line_function<int()>, 4> fs;
+    for (auto& f : fs)
+    {
+        CHECK(reinterpret_cast<std::uintptr_t>(&f) % 64 == 0);
+        f = [] { return 1; };
+    }
+    CHECK(fs[3]() == 1);
+}
+
+namespace {
+
+// Tells whether it was called as const.
+struct const_aware
+{
+    int operator()() { return 1; }
+    int operator()() const { return 2; }
+};
+
+} // namespace
+
+TEST_CASE("Target")
+{
+    SECTION("Function")
+    {
+        dze::function<int()> f;
+        CHECK(f.target<int>() == nullptr);
+
+        auto counter = [i = 0] () mutable { return ++i; };
+        f = counter;
+        CHECK(f.target<int>() == nullptr);
+        CHECK(f.target<decltype(counter)>() != nullptr);
+        f();
+        CHECK((*f.target<decltype(counter)>())() == 2);
+
+        f = nullptr;
+        CHECK(f.target<decltype(counter)>() == nullptr);
+    }
+
+    SECTION("Allocated")
+    {
+        std::array<int, 64> a{};
+        a[1] = 1;
+        auto big = [a] { return a[1]; };
+        const dze::function<int()> f = big;
+        REQUIRE(f.target<decltype(big)>() != nullptr);
+        CHECK(f.target<decltype(big)>()->operator()() == 1);
+
+        const dze::function<int()> g{dze::allocated, [] { return 2; }};
+        CHECK(g.target<decltype(big)>() == nullptr);
+    }
+
+    SECTION("Function pointer")
+    {
+        dze::function<int()> f = &two;
+        REQUIRE(f.target<int(*)()>() != nullptr);
+        CHECK(*f.target<int(*)()>() == &two);
+        CHECK(f.target<int(*)() noexcept>() == nullptr);
+    }
+
+    SECTION("Converted")
+    {
+        auto noexcept_lambda = [] () noexcept { return 3; };
+        dze::function<int() const noexcept> f = noexcept_lambda;
+        dze::function<int()> g = std::move(f);
+        CHECK(g.target<decltype(noexcept_lambda)>() != nullptr);
+
+        dze::copyable_function<int()> h = noexcept_lambda;
+        CHECK(h.target<decltype(noexcept_lambda)>() != nullptr);
+        const auto i = h;
+        CHECK(i.target<decltype(noexcept_lambda)>() != nullptr);
+    }
+
+    SECTION("Call if")
+    {
+        dze::function<int()> f = const_aware{};
+        CHECK(dze::call_if<const_aware>(f) == 1);
+        CHECK(dze::call_if<int(*)()>(f) == 1);
+
+        dze::function<int() const> g = const_aware{};
+        CHECK(dze::call_if<const_aware>(g) == 2);
+        CHECK(g() == 2);
+
+        dze::function<long(int)> h = [] (const int i) { return i * 2; };
+        CHECK(dze::call_if<const_aware>(h, 2) == 4);
+
+        dze::function<void()> v = const_aware{};
+        dze::call_if<const_aware>(v);
+    }
+}
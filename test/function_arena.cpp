@@ -0,0 +1,67 @@
+#include <dze/functional.hpp>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("Function arena bump allocation")
+{
+    dze::function_arena arena{64};
+
+    auto* const a = arena.allocate_bytes(8, 8);
+    auto* const b = arena.allocate_bytes(8, 8);
+    CHECK(static_cast<std::byte*>(b) == static_cast<std::byte*>(a) + 8);
+
+    auto* const c = arena.allocate_bytes(1, 64);
+    CHECK(reinterpret_cast<uintptr_t>(c) % 64 == 0);
+
+    // Does not fit in the first chunk.
+    auto* const d = arena.allocate_bytes(1000, 16);
+    CHECK(reinterpret_cast<uintptr_t>(d) % 16 == 0);
+
+    // Only the last chunk is kept.
+    arena.release();
+    CHECK(arena.allocate_bytes(1000, 16) == d);
+}
+
+TEST_CASE("Arena functions")
+{
+    using big = std::array<int, 32>;
+
+    int x = 0;
+    dze::function_arena arena;
+    {
+        dze::arena::function<int()> f{[&x] { return ++x; }, &arena};
+        CHECK(f() == 1);
+
+        big b{};
+        b[0] = 10;
+        dze::arena::function<int()> g{[b] { return b[0]; }, &arena};
+        CHECK(g() == 10);
+
+        f = std::move(g);
+        CHECK(f() == 10);
+        CHECK(!g);
+
+        // Functions with different arenas relocate into their own.
+        dze::function_arena other;
+        dze::arena::function<int()> h{&other};
+        h = std::move(f);
+        CHECK(h() == 10);
+    }
+
+    // Callables that are not trivially destructible are destroyed by the function.
+    auto counter = std::make_shared<int>(0);
+    {
+        big b{};
+        dze::arena::function<void()> f{[counter, b] { ++*counter; }, &arena};
+        f();
+        CHECK(counter.use_count() == 2);
+    }
+    CHECK(counter.use_count() == 1);
+    CHECK(*counter == 1);
+
+    arena.release();
+}
@@ -0,0 +1,139 @@
+#include <dze/functional.hpp>
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace {
+
+struct recorder
+{
+    std::vector<int>* calls;
+    int id;
+
+    void operator()(const int i) const { calls->push_back(id * 10 + i); }
+};
+
+// Same as recorder, but allocated by function.
+struct big_recorder
+{
+    std::vector<int>* calls;
+    int id;
+    std::array<int, 32> padding = {};
+
+    void operator()(const int i) const { calls->push_back(id * 10 + i); }
+};
+
+} // namespace
+
+TEST_CASE("Invoke all")
+{
+    std::vector<int> calls;
+
+    SECTION("Function")
+    {
+        std::vector<dze::function<void(int) const>> functions;
+        CHECK_NOTHROW(dze::invoke_all(functions, 1));
+
+        for (int id = 0; id != 20; ++id)
+        {
+            if (id % 3 == 0)
+                functions.emplace_back(big_recorder{&calls, id});
+            else
+                functions.emplace_back(recorder{&calls, id});
+        }
+
+        dze::invoke_all(functions, 1);
+        REQUIRE(calls.size() == 20);
+        for (int id = 0; id != 20; ++id)
+            CHECK(calls[id] == id * 10 + 1);
+
+        const auto& const_functions = functions;
+        calls.clear();
+        dze::invoke_all(const_functions, 2);
+        CHECK(calls.back() == 192);
+    }
+
+    SECTION("Copied arguments")
+    {
+        std::string s = "abc";
+        std::array<dze::copyable_function<void(std::string)>, 2> functions = {
+            [&] (std::string a) { s += a; },
+            [&] (std::string a) { s += std::move(a); }};
+
+        dze::invoke_all(functions, std::string{"d"});
+        CHECK(s == "abcdd");
+    }
+
+    SECTION("Reference arguments")
+    {
+        struct world
+        {
+            int updates = 0;
+        };
+
+        std::vector<dze::function<void(world&)>> functions;
+        functions.emplace_back([] (world& w) { ++w.updates; });
+        functions.emplace_back([] (world& w) { w.updates *= 10; });
+
+        world w;
+        dze::invoke_all(functions, w);
+        CHECK(w.updates == 10);
+    }
+
+    SECTION("Inplace function")
+    {
+        dze::inplace_function<void(int), 16> functions[] = {
+            recorder{&calls, 1}, recorder{&calls, 2}};
+        dze::invoke_all(functions, 3);
+        CHECK(calls == std::vector<int>{13, 23});
+    }
+}
+
+TEST_CASE("Group by stub")
+{
+    std::vector<int> calls;
+    std::vector<dze::function<void(int)>> functions;
+    auto negate = [&calls] (const int i) { calls.push_back(-i); };
+    for (int id = 0; id != 12; ++id)
+    {
+        switch (id % 3)
+        {
+        case 0:
+            functions.emplace_back(recorder{&calls, id});
+            break;
+        case 1:
+            functions.emplace_back(big_recorder{&calls, id});
+            break;
+        default:
+            functions.emplace_back(negate);
+        }
+    }
+
+    dze::group_by_stub(functions);
+    for (size_t i = 0; i != functions.size(); ++i)
+    {
+        // Each type is in one run.
+        if (i % 4 != 0)
+        {
+            CHECK(static_cast<bool>(functions[i].target<recorder>()) ==
+                static_cast<bool>(functions[i - 1].target<recorder>()));
+            CHECK(static_cast<bool>(functions[i].target<big_recorder>()) ==
+                static_cast<bool>(functions[i - 1].target<big_recorder>()));
+        }
+    }
+
+    dze::invoke_all(functions, 1);
+    REQUIRE(calls.size() == 12);
+
+    // The order of each type is kept.
+    std::vector<int> recorded;
+    for (const int call : calls)
+    {
+        if (call > 0 && (call / 10) % 3 == 0)
+            recorded.push_back(call);
+    }
+    CHECK(recorded == std::vector<int>{1, 31, 61, 91});
+}
@@ -0,0 +1,103 @@
+#include <dze/functional.hpp>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("Function queue order")
+{
+    dze::function_queue<dze::function<int()>> q{3};
+    CHECK(q.capacity() == 4);
+    CHECK(q.empty());
+    CHECK(!q.try_pop());
+
+    for (int i = 0; i != 4; ++i)
+        CHECK(q.try_push([i] { return i; }));
+
+    dze::function<int()> f = [] { return 4; };
+    CHECK(!q.try_push(std::move(f)));
+    CHECK(f() == 4);
+
+    for (int i = 0; i != 4; ++i)
+    {
+        auto g = q.try_pop();
+        REQUIRE(g);
+        CHECK((*g)() == i);
+    }
+    CHECK(q.empty());
+
+    // Wraps around.
+    for (int i = 0; i != 10; ++i)
+    {
+        std::array<int, 32> big{};
+        big[0] = i;
+        CHECK(q.try_push([big] { return big[0]; }));
+        CHECK((*q.try_pop())() == i);
+    }
+}
+
+TEST_CASE("Function queue destroys remaining functions")
+{
+    auto counter = std::make_shared<int>(0);
+    {
+        dze::function_queue<dze::copyable_function<void()>> q{8};
+        CHECK(q.try_emplace([counter] { ++*counter; }));
+        CHECK(q.try_emplace([counter] { ++*counter; }));
+        CHECK(counter.use_count() == 3);
+        (*q.try_pop())();
+        CHECK(counter.use_count() == 2);
+    }
+    CHECK(counter.use_count() == 1);
+    CHECK(*counter == 1);
+}
+
+TEST_CASE("Function queue concurrency")
+{
+    constexpr int producers = 4;
+    constexpr int consumers = 4;
+    constexpr int tasks_per_producer = 10000;
+
+    dze::function_queue<dze::function<void()>> q{64};
+    std::atomic<long> sum{0};
+    std::atomic<int> done{0};
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p != producers; ++p)
+    {
+        threads.emplace_back([&]
+        {
+            for (int i = 1; i <= tasks_per_producer; ++i)
+            {
+                while (!q.try_push([&sum, i] { sum += i; }))
+                    std::this_thread::yield();
+            }
+        });
+    }
+
+    for (int c = 0; c != consumers; ++c)
+    {
+        threads.emplace_back([&]
+        {
+            while (done.load() != producers * tasks_per_producer)
+            {
+                if (auto f = q.try_pop())
+                {
+                    (*f)();
+                    ++done;
+                }
+                else
+                    std::this_thread::yield();
+            }
+        });
+    }
+
+    for (auto& t : threads)
+        t.join();
+
+    CHECK(q.empty());
+    CHECK(sum == producers * (long{tasks_per_producer} * (tasks_per_producer + 1) / 2));
+}
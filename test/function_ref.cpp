@@ -0,0 +1,148 @@
+#include <dze/functional.hpp>
+
+#include <functional>
+#include <type_traits>
+
+#include <catch2/catch.hpp>
+
+namespace {
+
+int add_one(const int i) { return i + 1; }
+
+int add_two(const int i) noexcept { return i + 2; }
+
+struct counter
+{
+    int count = 0;
+
+    int operator()() { return ++count; }
+};
+
+struct const_counter
+{
+    int operator()() const { return 1; }
+    int operator()() { return 2; }
+};
+
+template <typename Signature>
+int call_with(const dze::function_ref<Signature> f, const int i)
+{
+    return f(i);
+}
+
+} // namespace
+
+TEST_CASE("Function reference traits")
+{
+    SECTION("Size")
+    {
+        STATIC_REQUIRE(sizeof(dze::function_ref<void()>) == 2 * sizeof(void*));
+        STATIC_REQUIRE(std::is_trivially_copyable_v<dze::function_ref<int(int) const>>);
+    }
+
+    SECTION("Constructibility")
+    {
+        STATIC_REQUIRE(!std::is_default_constructible_v<dze::function_ref<void()>>);
+
+        STATIC_REQUIRE(std::is_constructible_v<dze::function_ref<int()>, counter&>);
+        STATIC_REQUIRE(!std::is_constructible_v<dze::function_ref<int() const>, counter&>);
+        STATIC_REQUIRE(!std::is_constructible_v<dze::function_ref<int()>, const counter&>);
+        STATIC_REQUIRE(!std::is_constructible_v<dze::function_ref<int() noexcept>, counter&>);
+
+        STATIC_REQUIRE(std::is_constructible_v<dze::function_ref<int(int)>, int (*)(int)>);
+        STATIC_REQUIRE(
+            std::is_constructible_v<dze::function_ref<int(int) noexcept>, int (*)(int) noexcept>);
+        STATIC_REQUIRE(
+            !std::is_constructible_v<dze::function_ref<int(int) noexcept>, int (*)(int)>);
+        STATIC_REQUIRE(
+            !std::is_constructible_v<dze::function_ref<const int&(int)>, int (*)(int)>);
+
+        STATIC_REQUIRE(
+            std::is_constructible_v<dze::function_ref<int()>, dze::function<int()>&>);
+        STATIC_REQUIRE(
+            std::is_constructible_v<dze::function_ref<int()>, const dze::function<int() const>&>);
+        STATIC_REQUIRE(
+            !std::is_constructible_v<dze::function_ref<int()>, const dze::function<int()>&>);
+        STATIC_REQUIRE(
+            !std::is_constructible_v<dze::function_ref<int() const>, dze::function<int()>&>);
+        STATIC_REQUIRE(
+            std::is_constructible_v<dze::function_ref<long()>, dze::function<int()>&>);
+    }
+}
+
+TEST_CASE("Function reference to callable")
+{
+    counter c;
+    dze::function_ref<int()> f = c;
+    CHECK(f() == 1);
+    CHECK(f() == 2);
+    CHECK(c.count == 2);
+
+    const_counter cc;
+    CHECK(dze::function_ref<int() const>{cc}() == 1);
+    CHECK(dze::function_ref<int()>{cc}() == 2);
+    CHECK(dze::function_ref<int()>{std::as_const(cc)}() == 1);
+
+    CHECK(call_with<int(int) const>([] (const int i) { return i * 2; }, 21) == 42);
+
+    int x = 0;
+    auto by_ref = [&x] (int& i) { i = ++x; };
+    dze::function_ref<void(int&)> g = by_ref;
+    int out = 0;
+    g(out);
+    CHECK(out == 1);
+}
+
+TEST_CASE("Function reference to function pointer")
+{
+    CHECK(call_with<int(int)>(add_one, 1) == 2);
+    CHECK(call_with<int(int)>(&add_one, 1) == 2);
+    CHECK(call_with<int(int) const noexcept>(add_two, 1) == 3);
+    CHECK(call_with<long(int)>(add_one, 1) == 2);
+}
+
+TEST_CASE("Function reference to function")
+{
+    dze::function<int()> f = counter{};
+    dze::function_ref<int()> r = f;
+    CHECK(r() == 1);
+    CHECK(f() == 2);
+    CHECK(r() == 3);
+
+    dze::function<int(int) const noexcept> g = add_two;
+    const auto& cg = g;
+    dze::function_ref<int(int) const> r2 = cg;
+    CHECK(r2(0) == 2);
+
+    // The reference binds to the stored callable, not the function object.
+    int big[32]{};
+    dze::function<int(int) const> h = [big] (const int i) { return i + big[0]; };
+    dze::function_ref<int(int) const> r3 = h;
+    CHECK(r3(5) == 5);
+
+    // Signature conversion goes through the function.
+    dze::function<int()> i = [] { return 7; };
+    dze::function_ref<long()> r4 = i;
+    CHECK(r4() == 7);
+}
+
+TEST_CASE("Function reference deduction")
+{
+    STATIC_REQUIRE(std::is_same_v<
+        decltype(dze::function_ref{add_one}), dze::function_ref<int(int) const>>);
+    STATIC_REQUIRE(std::is_same_v<
+        decltype(dze::function_ref{add_two}), dze::function_ref<int(int) const noexcept>>);
+
+    auto l = [] (int i) { return i; };
+    STATIC_REQUIRE(std::is_same_v<decltype(dze::function_ref{l}), dze::function_ref<int(int) const>>);
+
+    auto m = [] () mutable noexcept {};
+    STATIC_REQUIRE(std::is_same_v<decltype(dze::function_ref{m}), dze::function_ref<void() noexcept>>);
+
+    dze::function<int(int)> f;
+    STATIC_REQUIRE(std::is_same_v<decltype(dze::function_ref{f}), dze::function_ref<int(int)>>);
+
+    dze::function_ref r = l;
+    dze::function_ref copy = r;
+    CHECK(copy(3) == 3);
+}
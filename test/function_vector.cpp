@@ -0,0 +1,216 @@
+#include <dze/functional.hpp>
+
+#include <array>
+#include <memory_resource>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace {
+
+struct lifetime_counter
+{
+    int live = 0;
+    int moves = 0;
+};
+
+// Not trivially relocatable, so growing the buffer goes through its move constructor.
+template <size_t Size>
+struct counted_callable
+{
+    lifetime_counter* counter;
+    std::vector<int>* out;
+    std::array<std::byte, Size> padding = {};
+
+    counted_callable(lifetime_counter& c, std::vector<int>& o) noexcept
+        : counter{&c}
+        , out{&o}
+    {
+        ++counter->live;
+    }
+
+    counted_callable(counted_callable&& other) noexcept
+        : counter{other.counter}
+        , out{other.out}
+    {
+        ++counter->live;
+        ++counter->moves;
+    }
+
+    counted_callable(const counted_callable&) = delete;
+    counted_callable& operator=(const counted_callable&) = delete;
+    counted_callable& operator=(counted_callable&&) = delete;
+
+    ~counted_callable() { --counter->live; }
+
+    void operator()(const int i) const { out->push_back(i + static_cast<int>(Size)); }
+};
+
+struct alignas(64) over_aligned
+{
+    std::vector<int>* out;
+
+    void operator()(const int i) const
+    {
+        CHECK(reinterpret_cast<uintptr_t>(this) % 64 == 0);
+        out->push_back(i);
+    }
+};
+
+} // namespace
+
+TEST_CASE("Function vector traits")
+{
+    STATIC_REQUIRE(std::is_nothrow_move_constructible_v<dze::function_vector<void()>>);
+    STATIC_REQUIRE(!std::is_copy_constructible_v<dze::function_vector<void()>>);
+
+    STATIC_REQUIRE(!std::is_invocable_v<const dze::function_vector<void()>&>);
+    STATIC_REQUIRE(std::is_invocable_v<const dze::function_vector<void() const>&>);
+}
+
+TEST_CASE("Function vector calls in order")
+{
+    std::vector<int> out;
+    dze::function_vector<void(int)> v;
+    CHECK(v.empty());
+    v(0);
+
+    v.push_back([&out] (const int i) { out.push_back(i); });
+    v.push_back([&out, a = std::array<int, 16>{{1}}] (const int i) { out.push_back(i + a[0]); });
+    v.push_back([&out] (const int i) mutable { out.push_back(i + 2); });
+    CHECK(v.size() == 3);
+
+    v(10);
+    CHECK(out == std::vector<int>{10, 11, 12});
+
+    // A header per entry followed by the captures.
+    constexpr size_t header_size = 2 * sizeof(void*);
+    CHECK(v.size_bytes() ==
+        header_size + sizeof(void*) + header_size + 72 + header_size + sizeof(void*));
+
+    v.clear();
+    CHECK(v.empty());
+    CHECK(v.size_bytes() == 0);
+    CHECK(v.capacity_bytes() != 0);
+    out.clear();
+    v(1);
+    CHECK(out.empty());
+}
+
+TEST_CASE("Function vector arguments")
+{
+    std::string result;
+    dze::function_vector<void(std::string) const> v;
+    for (int i = 0; i != 3; ++i)
+        v.push_back([&result] (std::string s) { result += std::move(s); });
+
+    v(std::string(32, 'a'));
+    CHECK(result == std::string(96, 'a'));
+
+    int x = 0;
+    dze::function_vector<void(int&) noexcept> refs;
+    refs.push_back([] (int& i) noexcept { ++i; });
+    refs.push_back([] (int& i) noexcept { i *= 10; });
+    refs(x);
+    CHECK(x == 10);
+
+    result.clear();
+    dze::function_vector<void(std::string&&)> rvalues;
+    rvalues.push_back([&result] (std::string&& s) { result += s; });
+    rvalues.push_back([&result] (std::string&& s) { result += std::move(s); });
+    rvalues(std::string{"ab"});
+    CHECK(result == "abab");
+}
+
+TEST_CASE("Function vector iteration")
+{
+    dze::function_vector<int(int)> v;
+    CHECK(v.begin() == v.end());
+
+    v.push_back([] (const int i) { return i; });
+    v.push_back([a = std::array<int, 16>{{1}}] (const int i) { return i + a[0]; });
+    v.push_back([n = 0] (const int i) mutable { return i + ++n; });
+
+    std::vector<int> results;
+    for (const auto f : v)
+        results.push_back(f(10));
+    CHECK(results == std::vector<int>{10, 11, 11});
+
+    auto it = v.begin();
+    ++it;
+    CHECK((*it)(1) == 2);
+    CHECK((*it++)(2) == 3);
+    CHECK((*it)(0) == 2);
+    CHECK(++it == v.end());
+    CHECK(std::distance(v.begin(), v.end()) == 3);
+
+    dze::function_vector<std::string(const std::string&) const> c;
+    c.push_back([] (const std::string& s) { return s + "!"; });
+    const auto& const_c = c;
+    CHECK((*const_c.begin())("a") == "a!");
+}
+
+TEST_CASE("Function vector growth")
+{
+    lifetime_counter counter;
+    std::vector<int> out;
+    {
+        dze::function_vector<void(int)> v;
+        for (int i = 0; i != 100; ++i)
+        {
+            if (i % 2 == 0)
+                v.emplace_back<counted_callable<8>>(counter, out);
+            else
+                v.emplace_back<counted_callable<40>>(counter, out);
+        }
+        CHECK(counter.live == 100);
+        CHECK(counter.moves > 0);
+
+        v.push_back(over_aligned{&out});
+        v(0);
+        REQUIRE(out.size() == 101);
+        CHECK(out[0] == 8);
+        CHECK(out[1] == 40);
+        CHECK(out[100] == 0);
+
+        auto w = std::move(v);
+        CHECK(v.empty());
+        CHECK(w.size() == 101);
+        CHECK(counter.live == 100);
+
+        w.clear();
+        CHECK(counter.live == 0);
+        w.emplace_back<counted_callable<8>>(counter, out);
+        CHECK(counter.live == 1);
+    }
+    CHECK(counter.live == 0);
+}
+
+TEST_CASE("Function vector allocators")
+{
+    lifetime_counter counter;
+    std::vector<int> out;
+    std::pmr::unsynchronized_pool_resource r1;
+    std::pmr::unsynchronized_pool_resource r2;
+    {
+        dze::pmr::function_vector<void(int)> v1{&r1};
+        dze::pmr::function_vector<void(int)> v2{&r2};
+        v1.emplace_back<counted_callable<16>>(counter, out);
+        v1.push_back(over_aligned{&out});
+        v2.emplace_back<counted_callable<8>>(counter, out);
+
+        v2 = std::move(v1);
+        CHECK(counter.live == 1);
+        CHECK(v1.empty());
+        CHECK(v2.size() == 2);
+        v2(1);
+        CHECK(out == std::vector<int>{17, 1});
+
+        dze::pmr::function_vector<void(int)> v3{std::pmr::null_memory_resource()};
+        v3 = std::move(v1);
+        CHECK(v3.empty());
+    }
+    CHECK(counter.live == 0);
+}
@@ -0,0 +1,168 @@
+#include <dze/functional.hpp>
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <catch2/catch.hpp>
+
+namespace {
+
+template <size_t Size>
+struct sized_callable
+{
+    std::array<std::byte, Size> padding{};
+
+    int operator()() const { return static_cast<int>(Size); }
+};
+
+struct alignas(64) overaligned_callable
+{
+    int operator()() const { return 64; }
+};
+
+struct throwing_move_callable
+{
+    throwing_move_callable() = default;
+    throwing_move_callable(throwing_move_callable&&) noexcept(false) {}
+
+    int operator()() const { return 0; }
+};
+
+struct move_counter
+{
+    int* moves;
+
+    explicit move_counter(int& m) noexcept
+        : moves{&m} {}
+
+    move_counter(move_counter&& other) noexcept
+        : moves{other.moves}
+    {
+        ++*moves;
+    }
+
+    int operator()() const { return *moves; }
+};
+
+} // namespace
+
+TEST_CASE("Inplace function traits")
+{
+    STATIC_REQUIRE(sizeof(dze::inplace_function<void()>) == sizeof(dze::function<void()>));
+    STATIC_REQUIRE(sizeof(dze::inplace_function<void(), 24, 8>) == 32);
+    STATIC_REQUIRE(alignof(dze::inplace_function<void(), 56, 64>) == 64);
+    STATIC_REQUIRE(sizeof(dze::inplace_function<void(), 56, 64>) == 64);
+    STATIC_REQUIRE(std::is_nothrow_move_constructible_v<dze::inplace_function<void()>>);
+    STATIC_REQUIRE(!std::is_copy_constructible_v<dze::inplace_function<void()>>);
+
+    using small = dze::inplace_function<int(), 16, 8>;
+    STATIC_REQUIRE(dze::function_fits_inline_v<small, sized_callable<16>>);
+    STATIC_REQUIRE(!dze::function_fits_inline_v<small, sized_callable<17>>);
+    STATIC_REQUIRE(!dze::function_fits_inline_v<small, overaligned_callable>);
+    STATIC_REQUIRE(!dze::function_fits_inline_v<small, throwing_move_callable>);
+
+    STATIC_REQUIRE(dze::function_fits_inline_v<dze::function<int()>, sized_callable<72>>);
+    STATIC_REQUIRE(!dze::function_fits_inline_v<dze::function<int()>, sized_callable<73>>);
+    STATIC_REQUIRE(
+        !dze::function_fits_inline_v<dze::function<int()>, throwing_move_callable>);
+    STATIC_REQUIRE(
+        dze::function_fits_inline_v<dze::copyable_function<int()>, sized_callable<72>>);
+    STATIC_REQUIRE(
+        dze::function_fits_inline_v<dze::cache_line_function<int()>, sized_callable<56>>);
+    STATIC_REQUIRE(
+        !dze::function_fits_inline_v<dze::cache_line_function<int()>, sized_callable<64>>);
+}
+
+TEST_CASE("Inplace function")
+{
+    SECTION("Empty")
+    {
+        dze::inplace_function<int()> f;
+        CHECK(!f);
+        CHECK(f == nullptr);
+
+        dze::inplace_function<int()> g = nullptr;
+        CHECK(!g);
+        CHECK(g.trivially_relocatable());
+    }
+
+    SECTION("Call")
+    {
+        dze::inplace_function<int(int), 16> f = [a = 1] (const int i) { return i + a; };
+        CHECK(f);
+        CHECK(f(1) == 2);
+
+        std::string s = "abc";
+        dze::inplace_function<size_t() const> g = [s] { return s.size(); };
+        CHECK(g() == 3);
+
+        f = nullptr;
+        CHECK(!f);
+    }
+
+    SECTION("Move")
+    {
+        int moves = 0;
+        dze::inplace_function<int()> f{std::in_place_type<move_counter>, moves};
+        CHECK(moves == 0);
+        CHECK(!f.trivially_relocatable());
+
+        auto g = std::move(f);
+        CHECK(!f);
+        CHECK(g() == 1);
+
+        f = std::move(g);
+        CHECK(f() == 2);
+
+        f.swap(g);
+        CHECK(!f);
+        CHECK(g() == 3);
+    }
+
+    SECTION("Emplace")
+    {
+        dze::inplace_function<int()> f = sized_callable<8>{};
+        f.emplace<sized_callable<72>>();
+        CHECK(f() == 72);
+    }
+
+    SECTION("Conversion")
+    {
+        dze::inplace_function<int(int) const noexcept, 16> f =
+            [] (const int i) noexcept { return i * 2; };
+        dze::inplace_function<int(int), 32> g = std::move(f);
+        CHECK(!f);
+        CHECK(g(2) == 4);
+    }
+
+    SECTION("Overloads")
+    {
+        dze::inplace_function<dze::overloads<int(int) const, int(const std::string&) const>> f =
+            [] (const auto& x)
+            {
+                if constexpr (std::is_same_v<std::decay_t<decltype(x)>, int>)
+                    return x;
+                else
+                    return static_cast<int>(x.size());
+            };
+        CHECK(f(3) == 3);
+        CHECK(f(std::string{"four"}) == 4);
+    }
+}
+
+TEST_CASE("Inplace function target")
+{
+    auto add = [a = 1] (const int i) { return i + a; };
+    dze::inplace_function<int(int), 16> f = add;
+    REQUIRE(f.target<decltype(add)>() != nullptr);
+    CHECK(f.target<int(*)(int)>() == nullptr);
+    CHECK(dze::call_if<decltype(add)>(f, 1) == 2);
+
+    f = nullptr;
+    CHECK(f.target<decltype(add)>() == nullptr);
+    CHECK(std::as_const(f).target<decltype(add)>() == nullptr);
+}
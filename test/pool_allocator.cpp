@@ -0,0 +1,89 @@
+#include <dze/functional.hpp>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <type_traits>
+
+#include <catch2/catch.hpp>
+
+namespace {
+
+// Destroyed after the cache of the main thread.
+dze::function<int(), dze::pool_allocator> static_function;
+
+} // namespace
+
+TEST_CASE("Pool allocator traits")
+{
+    using traits = std::allocator_traits<dze::pool_allocator>;
+    STATIC_REQUIRE(traits::is_always_equal::value);
+    STATIC_REQUIRE(traits::propagate_on_container_move_assignment::value);
+    STATIC_REQUIRE(traits::propagate_on_container_swap::value);
+    CHECK(dze::pool_allocator{} == dze::pool_allocator{});
+}
+
+TEST_CASE("Pool allocator reuses freed blocks")
+{
+    dze::pool_allocator alloc;
+
+    auto* const p = alloc.allocate_bytes(100, 16);
+    alloc.deallocate_bytes(p, 100, 16);
+
+    // Same size class.
+    auto* const q = alloc.allocate_bytes(112, 8);
+    CHECK(q == p);
+
+    // Other alignment class.
+    auto* const r = alloc.allocate_bytes(100, 64);
+    CHECK(r != p);
+    CHECK(reinterpret_cast<uintptr_t>(r) % 64 == 0);
+
+    // Not pooled.
+    auto* const s = alloc.allocate_bytes(4096, 16);
+    CHECK(s != nullptr);
+
+    alloc.deallocate_bytes(s, 4096, 16);
+    alloc.deallocate_bytes(r, 100, 64);
+    alloc.deallocate_bytes(q, 112, 8);
+
+    // Freed by another thread, which caches it until it exits.
+    auto* const t = alloc.allocate_bytes(200, 16);
+    std::thread{[t] { dze::pool_allocator{}.deallocate_bytes(t, 200, 16); }}.join();
+}
+
+TEST_CASE("Functions with a pool allocator")
+{
+    using function = dze::function<int(), dze::pool_allocator>;
+    using big = std::array<int, 32>;
+
+    big b{};
+    b[0] = 1;
+    function f = [b] { return b[0]; };
+    CHECK(f() == 1);
+
+    b[0] = 2;
+    function g = [b] { return b[0]; };
+    f = std::move(g);
+    CHECK(f() == 2);
+    CHECK(!g);
+
+    auto counter = std::make_shared<int>(0);
+    function h = [counter, b] { return ++*counter + b[0]; };
+    f.swap(h);
+    CHECK(f() == 3);
+    CHECK(h() == 2);
+
+    std::thread{[f = std::move(f)] () mutable { CHECK(f() == 4); }}.join();
+    CHECK(counter.use_count() == 1);
+}
+
+TEST_CASE("Functions with a pool allocator and static storage duration")
+{
+    std::array<int, 32> b{};
+    b[0] = 5;
+    static_function = [b] { return b[0]; };
+    CHECK(!static_function.is_inline());
+    CHECK(static_function() == 5);
+}
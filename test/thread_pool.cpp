@@ -0,0 +1,166 @@
+#include <dze/thread_pool.hpp>
+
+#include <array>
+#include <atomic>
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace {
+
+void wait_for(const std::atomic<int>& counter, const int value)
+{
+    while (counter.load() != value)
+        std::this_thread::yield();
+}
+
+template <typename Pool>
+void fan_out(Pool& pool, std::atomic<int>& leaves, const int depth) noexcept
+{
+    if (depth == 0)
+    {
+        ++leaves;
+        return;
+    }
+
+    for (int i = 0; i != 2; ++i)
+        pool.submit([&pool, &leaves, depth] () noexcept { fan_out(pool, leaves, depth - 1); });
+}
+
+} // namespace
+
+TEST_CASE("Work stealing deque")
+{
+    dze::details::function_ns::work_stealing_deque<dze::function<int()>> d{3};
+    CHECK(d.capacity() == 4);
+    CHECK(d.empty());
+    CHECK(!d.pop());
+    CHECK(!d.steal());
+
+    for (int i = 0; i != 4; ++i)
+        CHECK(d.push([i] { return i; }));
+    CHECK(!d.push([] { return 4; }));
+
+    // The owner pops the newest, thieves steal the oldest.
+    CHECK((*d.pop())() == 3);
+    CHECK((*d.steal())() == 0);
+    CHECK((*d.steal())() == 1);
+    CHECK((*d.pop())() == 2);
+    CHECK(d.empty());
+
+    // Wraps around.
+    for (int i = 0; i != 10; ++i)
+    {
+        std::array<int, 32> big{};
+        big[0] = i;
+        CHECK(d.push([big] { return big[0]; }));
+        CHECK((*d.steal())() == i);
+    }
+}
+
+TEST_CASE("Work stealing deque concurrency")
+{
+    constexpr int tasks = 20000;
+
+    dze::details::function_ns::work_stealing_deque<dze::function<void()>> d{64};
+    std::atomic<long> sum{0};
+    std::atomic<int> done{0};
+
+    std::vector<std::thread> thieves;
+    for (int t = 0; t != 3; ++t)
+    {
+        thieves.emplace_back([&]
+        {
+            while (done.load() != tasks)
+            {
+                if (auto f = d.steal())
+                {
+                    (*f)();
+                    ++done;
+                }
+                else
+                    std::this_thread::yield();
+            }
+        });
+    }
+
+    for (int i = 1; i <= tasks; ++i)
+    {
+        while (!d.push([&sum, i] { sum += i; }))
+        {
+            if (auto f = d.pop())
+            {
+                (*f)();
+                ++done;
+            }
+        }
+    }
+
+    while (auto f = d.pop())
+    {
+        (*f)();
+        ++done;
+    }
+
+    for (auto& t : thieves)
+        t.join();
+
+    CHECK(d.empty());
+    CHECK(sum == long{tasks} * (tasks + 1) / 2);
+}
+
+TEST_CASE("Thread pool runs submitted tasks")
+{
+    std::atomic<int> counter{0};
+    dze::thread_pool<> pool{4, 8, 8};
+    CHECK(pool.thread_count() == 4);
+
+    // More tasks than the queues can hold.
+    for (int i = 0; i != 1000; ++i)
+        pool.submit([&counter] () noexcept { ++counter; });
+
+    wait_for(counter, 1000);
+}
+
+TEST_CASE("Thread pool fork join")
+{
+    std::atomic<int> leaves{0};
+    dze::thread_pool<> pool{4, 16};
+    pool.submit([&pool, &leaves] () noexcept { fan_out(pool, leaves, 12); });
+    wait_for(leaves, 1 << 12);
+}
+
+TEST_CASE("Thread pool runs the remaining tasks when destroyed")
+{
+    std::atomic<int> leaves{0};
+    {
+        dze::thread_pool<> pool{2};
+        for (int i = 0; i != 4; ++i)
+            pool.submit([&pool, &leaves] () noexcept { fan_out(pool, leaves, 8); });
+    }
+    CHECK(leaves == 4 << 8);
+}
+
+TEST_CASE("Thread pool with a memory resource")
+{
+    std::atomic<int> counter{0};
+    std::pmr::synchronized_pool_resource resource;
+    {
+        dze::pmr::thread_pool pool{3};
+        for (int i = 0; i != 100; ++i)
+        {
+            std::array<int, 64> big{};
+            big[0] = 1;
+            pool.submit([&counter, big] () noexcept { counter += big[0]; }, &resource);
+        }
+
+        wait_for(counter, 100);
+    }
+
+    // Tasks from an allocator that can not allocate must fit inline.
+    dze::pmr::thread_pool pool{1};
+    pool.submit([&counter] () noexcept { ++counter; }, std::pmr::null_memory_resource());
+    wait_for(counter, 101);
+}